@@ -0,0 +1,214 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ * https://www.usenix.org/conference/atc16/technical-sessions/presentation/xia
+ */
+
+#include "../include/binary_diff.hpp"
+#include "hashing.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HeckelDiff {
+
+    namespace {
+
+        // Gear table for the rolling hash, every byte value maps to a fixed pseudo random word.
+        const std::array<uint64_t, 256> &gear() {
+
+            static const auto table = [] {
+
+                std::array<uint64_t, 256> t {};
+                uint64_t seed = 0x9e3779b97f4a7c15;
+
+                for (auto &word : t) {
+                    seed += 0x9e3779b97f4a7c15;
+                    word = mix_bits(seed);
+                }
+
+                return t;
+            }();
+
+            return table;
+        }
+
+        uint64_t fingerprint(const uint8_t *data, const size_t length) {
+
+            auto hash = mix_bits(length);
+            size_t i = 0;
+
+            for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+
+                uint64_t word;
+                std::memcpy(&word, data + i, sizeof(word));
+
+                hash = mix_bits(hash ^ word);
+            }
+
+            if (i < length) {
+
+                uint64_t word = 0;
+                std::memcpy(&word, data + i, length - i);
+
+                hash = mix_bits(hash ^ word);
+            }
+
+            return hash;
+        }
+
+        void validate(const ChunkingOptions &options) {
+
+            const auto average = options.average_size;
+
+            if (options.min_size == 0 || average < 2 || (average & (average - 1)) != 0
+                || options.min_size > average || average > options.max_size) {
+
+                throw std::invalid_argument(
+                        "chunk sizes must satisfy 0 < min <= average <= max, average a power of two");
+            }
+        }
+    }  // namespace
+
+    BinaryAlgorithm::BinaryAlgorithm(const ChunkingOptions &options) : options(options) {
+        validate(options);
+    }
+
+    // Gear based content-defined chunking: cut wherever the top bits of the rolling hash are all zero.
+    std::vector<Chunk> BinaryAlgorithm::chunks(const uint8_t *data, const size_t size,
+                                               const ChunkingOptions &options) {
+
+        validate(options);
+
+        const auto &table = gear();
+
+        size_t bits = 0;
+
+        while ((static_cast<size_t>(1) << bits) < options.average_size) {
+            bits += 1;
+        }
+
+        // the top bits depend on the last 64 bytes, the low bits only on the last few
+        const uint64_t mask = bits == 0 ? 0 : ~static_cast<uint64_t>(0) << (64 - bits);
+
+        std::vector<Chunk> result;
+        result.reserve(size / options.average_size + 1);
+
+        size_t start = 0;
+
+        while (start < size) {
+
+            const auto end = std::min(size, start + options.max_size);
+            auto cut = start + options.min_size;
+
+            if (cut >= end) {
+
+                cut = end;
+
+            } else {
+
+                uint64_t hash = 0;
+
+                for (; cut < end; cut += 1) {
+
+                    hash = (hash << 1) + table[data[cut]];
+
+                    if ((hash & mask) == 0) {
+                        cut += 1;
+                        break;
+                    }
+                }
+            }
+
+            Chunk chunk;
+
+            chunk.offset = start;
+            chunk.length = cut - start;
+            chunk.fingerprint = fingerprint(data + start, chunk.length);
+
+            result.push_back(chunk);
+
+            start = cut;
+        }
+
+        return result;
+    }
+
+    std::unordered_map<std::string, std::vector<ByteRange>> BinaryAlgorithm::diff(const uint8_t *original,
+                                                                                   const size_t original_size,
+                                                                                   const uint8_t *updated,
+                                                                                   const size_t updated_size) {
+
+        const auto original_chunks = chunks(original, original_size, options);
+        const auto updated_chunks = chunks(updated, updated_size, options);
+
+        std::vector<size_t> o(original_chunks.size());
+        std::vector<size_t> n(updated_chunks.size());
+
+        std::transform(original_chunks.begin(), original_chunks.end(), o.begin(),
+                       [](const Chunk &chunk) { return static_cast<size_t>(chunk.fingerprint); });
+        std::transform(updated_chunks.begin(), updated_chunks.end(), n.begin(),
+                       [](const Chunk &chunk) { return static_cast<size_t>(chunk.fingerprint); });
+
+        const auto baseline = PreparedBaseline<size_t>::prepare(o);
+        const auto alignments = algorithm.align(baseline, n);
+
+        std::vector<ByteRange> copied, moved, literal;
+
+        // the original chunk the previous updated chunk came from, a repeated run is read from one place
+        auto previous = NotFound;
+
+        for (size_t i = 0; i < updated_chunks.size(); i += 1) {
+
+            const auto &chunk = updated_chunks[i];
+            const auto &alignment = alignments[i];
+
+            ByteRange range;
+
+            range.updated_offset = chunk.offset;
+            range.length = chunk.length;
+
+            if (alignment.old_index != NotFound) {
+
+                previous = alignment.old_index;
+                range.original_offset = original_chunks[previous].offset;
+
+                append_range(alignment.unchanged ? copied : moved, range);
+
+                continue;
+            }
+
+            // Heckel pairs each original chunk once, a chunk repeated in the update is still in the original
+            const auto symbol = baseline.find(n[i]);
+
+            if (symbol == PreparedBaseline<size_t>::NoSymbol) {
+
+                previous = NotFound;
+                append_range(literal, range);
+
+                continue;
+            }
+
+            previous = previous != NotFound && previous + 1 < o.size() && o[previous + 1] == n[i]
+                       ? previous + 1
+                       : static_cast<size_t>(baseline.old_indexes(symbol)[0]);
+
+            range.original_offset = original_chunks[previous].offset;
+
+            append_range(moved, range);
+        }
+
+        const std::unordered_map<std::string, std::vector<ByteRange>> results {
+                {COPIED,  copied},
+                {MOVED,   moved},
+                {LITERAL, literal}
+        };
+
+        return results;
+    }
+
+}  // namespace HeckelDiff
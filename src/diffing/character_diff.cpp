@@ -0,0 +1,206 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include "../include/character_diff.hpp"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HeckelDiff {
+
+    namespace {
+
+        const uint64_t HighBits = 0x8080808080808080;
+
+        // Length of the well-formed sequence at `bytes`, 0 if there is none (Unicode Table 3-7).
+        size_t sequence_length(const unsigned char *bytes, const size_t available, uint32_t &code_point) {
+
+            const auto lead = bytes[0];
+
+            size_t length;
+            unsigned char low = 0x80;
+            unsigned char high = 0xbf;
+
+            if (lead >= 0xc2 && lead <= 0xdf) {
+
+                length = 2;
+                code_point = lead & 0x1fu;
+
+            } else if (lead >= 0xe0 && lead <= 0xef) {
+
+                length = 3;
+                code_point = lead & 0x0fu;
+
+                if (lead == 0xe0) {
+                    low = 0xa0;
+                } else if (lead == 0xed) {
+                    high = 0x9f;
+                }
+
+            } else if (lead >= 0xf0 && lead <= 0xf4) {
+
+                length = 4;
+                code_point = lead & 0x07u;
+
+                if (lead == 0xf0) {
+                    low = 0x90;
+                } else if (lead == 0xf4) {
+                    high = 0x8f;
+                }
+
+            } else {
+
+                return 0;
+            }
+
+            if (length > available || bytes[1] < low || bytes[1] > high) {
+                return 0;
+            }
+
+            for (size_t i = 1; i < length; i += 1) {
+
+                if (i > 1 && (bytes[i] & 0xc0) != 0x80) {
+                    return 0;
+                }
+
+                code_point = (code_point << 6) | (bytes[i] & 0x3fu);
+            }
+
+            return length;
+        }
+    }  // namespace
+
+    const uint32_t CharacterAlgorithm::InvalidByte;
+
+    void CharacterAlgorithm::decode(const std::string &text, std::vector<uint32_t> &ids,
+                                    std::vector<uint32_t> &offsets) {
+
+        if (text.size() >= std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("text too long to diff by character");
+        }
+
+        const auto bytes = reinterpret_cast<const unsigned char *>(text.data());
+        const auto size = text.size();
+
+        ids.reserve(ids.size() + size);
+        offsets.reserve(offsets.size() + size + 1);
+
+        size_t i = 0;
+
+        while (i < size) {
+
+            // ASCII fast path, eight bytes to a word: one test decides whether each byte is its own code point
+            while (i + sizeof(uint64_t) <= size) {
+
+                uint64_t word;
+                std::memcpy(&word, bytes + i, sizeof(word));
+
+                if ((word & HighBits) != 0) {
+                    break;
+                }
+
+                for (size_t j = 0; j < sizeof(uint64_t); j += 1) {
+
+                    ids.push_back(bytes[i + j]);
+                    offsets.push_back(static_cast<uint32_t>(i + j));
+                }
+
+                i += sizeof(uint64_t);
+            }
+
+            if (i >= size) {
+                break;
+            }
+
+            offsets.push_back(static_cast<uint32_t>(i));
+
+            if (bytes[i] < 0x80) {
+
+                ids.push_back(bytes[i]);
+                i += 1;
+
+                continue;
+            }
+
+            uint32_t code_point = 0;
+            const auto length = sequence_length(bytes + i, size - i, code_point);
+
+            if (length == 0) {
+
+                ids.push_back(InvalidByte + bytes[i]);
+                i += 1;
+
+            } else {
+
+                ids.push_back(code_point);
+                i += length;
+            }
+        }
+
+        offsets.push_back(static_cast<uint32_t>(size));
+    }
+
+    std::unordered_map<std::string, std::vector<ByteRange>> CharacterAlgorithm::diff(const std::string &original,
+                                                                                      const std::string &updated) {
+
+        original_ids.clear();
+        original_offsets.clear();
+        updated_ids.clear();
+        updated_offsets.clear();
+
+        decode(original, original_ids, original_offsets);
+        decode(updated, updated_ids, updated_offsets);
+
+        auto changes = algorithm.changes(original_ids, updated_ids);
+
+        std::vector<ByteRange> inserted, deleted, moved, unchanged;
+
+        // one walk over the update sorts every matched item, a matched code point decodes from the same bytes on
+        // both sides so the lengths agree
+        const auto alignments = changes.alignments();
+
+        for (size_t i = 0; i < alignments.size(); i += 1) {
+
+            ByteRange range;
+
+            range.updated_offset = updated_offsets[i];
+            range.length = updated_offsets[i + 1] - updated_offsets[i];
+
+            if (alignments[i].old_index == NotFound) {
+                append_range(inserted, range);
+                continue;
+            }
+
+            range.original_offset = original_offsets[alignments[i].old_index];
+
+            append_range(alignments[i].unchanged ? unchanged : moved, range);
+        }
+
+        for (auto it = changes.deleted().begin(); it != changes.deleted().end(); ++it) {
+
+            ByteRange range;
+
+            range.original_offset = original_offsets[it.index()];
+            range.length = original_offsets[it.index() + 1] - original_offsets[it.index()];
+
+            append_range(deleted, range);
+        }
+
+        algorithm.recycle(std::move(changes));
+
+        std::unordered_map<std::string, std::vector<ByteRange>> results;
+
+        results.emplace(INSERTED, std::move(inserted));
+        results.emplace(MOVED, std::move(moved));
+        results.emplace(UNCHANGED, std::move(unchanged));
+        results.emplace(DELETED, std::move(deleted));
+
+        return results;
+    }
+
+}  // namespace HeckelDiff
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef DirectTable_H
+#define DirectTable_H
+
+#include <cstdint>
+#include <vector>
+
+namespace HeckelDiff {
+
+    // Integral items are indexed by value - min, in place of hashing, while the table needs no more slots than this
+    // per item.
+    const uint64_t DirectSlotsPerItem = 4;
+
+    // Whether `items` are dense enough for a direct table, setting the smallest of them and the slots needed if so.
+    template<typename T>
+    bool fits_direct_table(const std::vector<T> &items, T &min, uint64_t &slots) {
+
+        if (items.empty()) {
+            return false;
+        }
+
+        min = items.front();
+        auto max = items.front();
+
+        for (const auto &item : items) {
+
+            if (item < min) {
+                min = item;
+            } else if (max < item) {
+                max = item;
+            }
+        }
+
+        const auto span = static_cast<uint64_t>(max) - static_cast<uint64_t>(min);
+
+        if (span >= DirectSlotsPerItem * items.size()) {
+            return false;
+        }
+
+        slots = span + 1;
+
+        return true;
+    }
+}
+
+#endif //DirectTable_H
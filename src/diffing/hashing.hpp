@@ -0,0 +1,40 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef Hashing_H
+#define Hashing_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HeckelDiff {
+
+    // splitmix64 finaliser. Unlike std::hash, stable across builds and platforms.
+    inline uint64_t mix_bits(uint64_t x) {
+
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111eb;
+        x ^= x >> 31;
+
+        return x;
+    }
+
+    // FNV-1a over `length` bytes. Its low bits mix poorly, so pass it through mix_bits before masking.
+    inline uint64_t fnv1a(const char *bytes, const size_t length) {
+
+        uint64_t hash = 0xcbf29ce484222325;
+
+        for (size_t i = 0; i < length; i += 1) {
+
+            hash ^= static_cast<unsigned char>(bytes[i]);
+            hash *= 0x100000001b3;
+        }
+
+        return hash;
+    }
+}
+
+#endif //Hashing_H
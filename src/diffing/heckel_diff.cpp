@@ -4,89 +4,189 @@
  */
 
 #include "../include/heckel_diff.hpp"
+#include "direct_table.hpp"
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
-#include <stack>
 #include <limits>
+#include <stdexcept>
 #include <memory>
-#include <functional>
-#include <tuple>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <type_traits>
 
 namespace HeckelDiff {
-    
-    // Pass 1 & 2: Index the items being diffed
-    template<typename T>
-    void Algorithm<T>::index_item(const T &item,
-                                  std::unordered_map<T, std::unique_ptr<Entry>> &symbol_table,
-                                  std::function<void(Entry *&entry, const T &l_item)> &lambda) {
 
-        std::unique_ptr<Entry> entry_ptr = nullptr;
-        Entry *entry;
-        auto is_new_item = false;
+    namespace {
 
-        if (symbol_table[item]) {
+        // Runs `body(segment)` for every segment, the first on the calling thread.
+        template<typename Body>
+        void run_segments(const size_t segments, const Body &body) {
 
-            entry = symbol_table[item].get();
+            std::vector<std::future<void>> futures;
 
-        } else {
+            for (size_t segment = 1; segment < segments; segment += 1) {
+                futures.push_back(std::async(std::launch::async, [&body, segment] { body(segment); }));
+            }
+
+            body(0);
+
+            for (auto &future : futures) {
+                future.get();
+            }
+        }
+
+        template<typename T>
+        std::vector<T> joined(std::vector<std::vector<T>> &parts) {
+
+            if (parts.size() == 1) {
+                return std::move(parts.front());
+            }
+
+            size_t size = 0;
+
+            for (const auto &part : parts) {
+                size += part.size();
+            }
+
+            std::vector<T> result;
+            result.reserve(size);
+
+            for (auto &part : parts) {
+                std::move(part.begin(), part.end(), std::back_inserter(result));
+            }
+
+            return result;
+        }
+
+        /*
+         * Pass 1 for dense integral items: a table indexed by value - min remembers the entry of each value, so
+         * every distinct value is looked up in the baseline once and nothing is hashed into the symbol table.
+         */
+        template<typename T, typename Count>
+        bool index_directly(const std::vector<T> &n, const PreparedBaseline<T> &baseline, std::vector<uint32_t> &table,
+                            std::vector<Entry> &entries, const Count &count, std::true_type) {
+
+            T min;
+            uint64_t slots;
+
+            if (!fits_direct_table(n, min, slots)) {
+                return false;
+            }
+
+            table.assign(slots, Records::Unmatched);
 
-            entry_ptr = std::make_unique<Entry>();
-            entry = entry_ptr.get();
-            is_new_item = true;
+            for (size_t i = 0; i < n.size(); i += 1) {
+
+                auto &entry = table[static_cast<uint64_t>(n[i]) - static_cast<uint64_t>(min)];
+
+                if (entry == Records::Unmatched) {
+
+                    const auto symbol = baseline.find(n[i]);
+
+                    if (symbol != PreparedBaseline<T>::NoSymbol) {
+
+                        entry = static_cast<uint32_t>(symbol);
+
+                    } else {
+
+                        entry = static_cast<uint32_t>(entries.size());
+                        entries.emplace_back();
+                    }
+                }
+
+                count(i, entry);
+            }
+
+            return true;
         }
 
-        lambda(entry, item);
+        template<typename T, typename Count>
+        bool index_directly(const std::vector<T> &, const PreparedBaseline<T> &, std::vector<uint32_t> &,
+                            std::vector<Entry> &, const Count &, std::false_type) {
+            return false;
+        }
+    }  // namespace
 
-        if (is_new_item) {
-            symbol_table[item] = std::move(entry_ptr);
+    const uint32_t Records::Unmatched;
+
+    // Pass 1: Index the items being diffed
+    template<typename T>
+    uint32_t Algorithm<T>::index_item(const T &item,
+                                      const PreparedBaseline<T> &baseline,
+                                      std::unordered_map<T, uint32_t> &symbol_table,
+                                      std::vector<Entry> &entries) {
+
+        const auto symbol = baseline.find(item);
+
+        if (symbol != PreparedBaseline<T>::NoSymbol) {
+            return static_cast<uint32_t>(symbol);
         }
+
+        const auto inserted = symbol_table.emplace(item, static_cast<uint32_t>(entries.size()));
+
+        if (inserted.second) {
+            entries.emplace_back();
+        }
+
+        return inserted.first->second;
     }
 
     // Pass 1: Put new text into entry table
     template<typename T>
     void Algorithm<T>::pass1(const std::vector<T> &n,
-                             std::unordered_map<T, std::unique_ptr<Entry>> &symbol_table,
-                             std::vector<Record<T>> &na) {
+                             const PreparedBaseline<T> &baseline,
+                             std::unordered_map<T, uint32_t> &symbol_table,
+                             std::vector<uint32_t> &direct_table,
+                             std::vector<Entry> &entries,
+                             std::vector<uint32_t> &ranks,
+                             Records &na) {
 
-        size_t i = 0;
+        const auto count = [&entries, &ranks, &na](const size_t i, const uint32_t entry) {
 
-        std::function<void(Entry *&entry, const T &item)> l = [&na, &i](Entry *&entry, const T &l_item) {
+            if (!ranks.empty()) {
+                ranks[i] = static_cast<uint32_t>(entries[entry].nc);
+            }
 
-            entry->nc += 1;
-            entry->all_old_indexes.push(NotFound);
+            entries[entry].nc += 1;
+            na.entries[i] = entry;
+        };
 
-            na[i] = Record<T>(l_item, entry);
+        if (index_directly(n, baseline, direct_table, entries, count, std::is_integral<T>())) {
+            return;
+        }
 
-            i += 1;
-        };
+        for (size_t i = 0; i < n.size(); i += 1) {
 
-        for (auto it = n.begin(); n.end() > it; it += 1) {
-            index_item(n[i], symbol_table, l);
+            count(i, index_item(n[i], baseline, symbol_table, entries));
         }
     }
 
     // Pass 2: Put old text into entry table
+    /*
+     * The original was hashed when the baseline was prepared, all that remains is to give each of its symbols an
+     * entry. This runs ahead of pass 1 so that the baseline's symbols take the first entry ids.
+     */
     template<typename T>
-    void Algorithm<T>::pass2(const std::vector<T> &o,
-                             std::unordered_map<T, std::unique_ptr<Entry>> &symbol_table,
-                             std::vector<Record<T>> &oa) {
+    void Algorithm<T>::pass2(const PreparedBaseline<T> &baseline,
+                             std::vector<Entry> &entries,
+                             Records &oa) {
 
-        size_t i = 0;
+        entries.resize(baseline.symbol_count());
 
-        std::function<void(Entry *&entry, const T &item)> l = [&oa, &i](Entry *&entry, const T &l_item) {
+        for (size_t symbol = 0; symbol < entries.size(); symbol += 1) {
 
-            entry->oc += 1;
-            entry->all_old_indexes. push(i);
+            auto &entry = entries[symbol];
 
-            oa[i] = Record<T>(l_item, entry);
+            entry.oc = baseline.occurrences(symbol);
+            entry.all_old_indexes = baseline.old_indexes(symbol);
+        }
 
-            i += 1;
-        };
+        for (size_t i = 0; i < oa.size(); i += 1) {
 
-        // go backwards to preserve the order of stack indexes
-        for (auto it = o.end(); o.begin() != it; it -= 1) {
-            index_item(o[i], symbol_table, l);
+            oa.entries[i] = static_cast<uint32_t>(baseline.symbol_at(i));
         }
     }
 
@@ -97,73 +197,142 @@ namespace HeckelDiff {
      * We use this observation to locate unaltered lines that we subsequently exclude from further treatment.
      */
     template<typename T>
-    void Algorithm<T>::pass3(std::vector<Record<T>> &na, std::vector<Record<T>> &oa) {
+    void Algorithm<T>::pass3(Records &na, Records &oa, std::vector<Entry> &entries) {
 
-        size_t new_index = 0;
-
-        for (const auto &record : na) {
+        for (size_t new_index = 0; new_index < na.size(); new_index += 1) {
 
             if (new_index >= oa.size()) {
                 return;
             }
 
-            auto &entry = record.entry;
+            auto &entry = entries[na.entries[new_index]];
 
-            auto old_index = entry->all_old_indexes.top();
-            entry->all_old_indexes.pop();
+            auto old_index = entry.top();
+            entry.pop();
 
             // if we find an item that has moved but that may have had variance from oc to nc, allow a reverse lookup
-            if (old_index != NotFound && na[new_index] == oa[old_index]) {
+            if (old_index != NotFound && na.equals(new_index, oa, old_index)) {
 
-                na[new_index].set_index(old_index);
+                na.set_index(new_index, old_index);
             }
 
-            if (entry->nc == entry->oc && entry->oc > 0) {
+            if (entry.nc == entry.oc && entry.oc > 0) {
 
-                oa[old_index].set_index(new_index);
-                na[new_index].set_index(old_index);
+                oa.set_index(old_index, new_index);
+                na.set_index(new_index, old_index);
             }
-
-            new_index += 1;
         }
     }
 
+    /*
+     * Pass 3 in segments. The new item at `i` would find its entry popped once for every earlier new item sharing
+     * it, which pass 1 counted as its rank, so each item's old index is known up front and no two items pop the
+     * same one. Entries are left unpopped, nothing after pass 3 reads the cursor.
+     */
     template<typename T>
-    void Algorithm<T>::find_unchanged_blocks(const Record<T> &record, const Direction &direction, const size_t &i,
-                                      std::vector<Record<T>> &na,
-                                      std::vector<Record<T>> &oa) {
+    void Algorithm<T>::pass3(Records &na, Records &oa, const std::vector<Entry> &entries,
+                             const std::vector<uint32_t> &ranks, const size_t segments) {
 
-        switch (record.type) {
+        const auto size = std::min(na.size(), oa.size());
 
-            case Record<T>::LineNumber: {
+        run_segments(segments, [&](const size_t segment) {
 
-                const auto &index = record.index();
+            const auto end = (segment + 1) * size / segments;
 
-                const auto new_index = i + direction;
-                const auto old_index = index + direction;
+            for (auto new_index = segment * size / segments; new_index < end; new_index += 1) {
 
-                if (new_index >= na.size() || new_index >= oa.size()) {
-                    return;
-                }
+                const auto &entry = entries[na.entries[new_index]];
+
+                const auto old_index = ranks[new_index] < entry.oc
+                                       ? static_cast<size_t>(entry.all_old_indexes[entry.oc - 1 - ranks[new_index]])
+                                       : NotFound;
 
-                if (old_index >= na.size() || old_index >= oa.size()) {
-                    return;
+                if (old_index != NotFound && na.equals(new_index, oa, old_index)) {
+
+                    na.set_index(new_index, old_index);
                 }
 
-                if (na[new_index] != oa[old_index]) {
-                    return;
+                if (entry.nc == entry.oc && entry.oc > 0) {
+
+                    oa.set_index(old_index, new_index);
+                    na.set_index(new_index, old_index);
                 }
+            }
+        });
+    }
+
+    /*
+     * Segment boundaries for passes 4 and 5, `segments` roughly equal ranges of the new items each starting at an
+     * anchor: an item unique to both sides, so matched by pass 3. Blocks can only extend onto an anchor's record
+     * from its own match, which it already holds, so neither pass changes an anchor and a segment never depends
+     * on the one before it through the new items.
+     */
+    template<typename T>
+    std::vector<size_t> Algorithm<T>::find_anchors(const Records &na, const Records &oa,
+                                                   const std::vector<Entry> &entries, const size_t segments) {
+
+        std::vector<size_t> boundaries {0};
+
+        // pass 3 stops at the end of the original
+        const auto matched = std::min(na.size(), oa.size());
+
+        for (size_t segment = 1; segment < segments; segment += 1) {
 
-                na[new_index].set_index(old_index);
-                oa[old_index].set_index(new_index);
+            auto i = std::max(boundaries.back() + 1, segment * na.size() / segments);
+            const auto end = std::min(matched, (segment + 1) * na.size() / segments);
 
-                break;
+            while (i < end && !(entries[na.entries[i]].oc == 1 && entries[na.entries[i]].nc == 1)) {
+                i += 1;
             }
 
-            case Record<T>::SymbolTableEntry:
-            default:
-                break;
+            if (i < end) {
+                boundaries.push_back(i);
+            }
         }
+
+        boundaries.push_back(na.size());
+
+        return boundaries;
+    }
+
+    template<typename T>
+    template<typename Original>
+    bool Algorithm<T>::find_unchanged_blocks(const Direction &direction, const size_t &i, Records &na, Records &oa,
+                                             Original &original) {
+
+        // only line numbers extend a block, symbol table entries have yet to be matched
+        if (na.indexes[i] == Records::Unmatched) {
+            return true;
+        }
+
+        const auto new_index = i + direction;
+        const auto old_index = na.index(i) + direction;
+
+        if (new_index >= na.size() || new_index >= oa.size()) {
+            return true;
+        }
+
+        if (old_index >= na.size() || old_index >= oa.size()) {
+            return true;
+        }
+
+        // symbols never change, only whether the old record is matched depends on the steps before
+        if (na.entries[new_index] != oa.entries[old_index]) {
+            return true;
+        }
+
+        if (!original.claim(old_index)) {
+            return false;
+        }
+
+        if (!na.equals(new_index, oa, old_index)) {
+            return true;
+        }
+
+        na.set_index(new_index, old_index);
+        original.set_index(old_index, new_index);
+
+        return true;
     }
 
     // Pass 4 & 5: Find blocks of unchanged lines.
@@ -173,123 +342,301 @@ namespace HeckelDiff {
      * then these lines must be the same line. This information can be used to find blocks of unchanged lines.
      */
 
-    // Pass 4: Find ascending connected blocks
+    /*
+     * Runs pass 4 or 5 with each segment on its own thread. A segment's steps only move within its own new items,
+     * but a block can reach any original item, and what a step sees of one is whether it is matched:
+     *  - items matched before the pass stay matched, any segment may read them and their rewrites are replayed in
+     *    order afterwards
+     *  - the rest belong to the first segment to touch them, a second segment touching one depends on the order
+     *    the two run in
+     * Segments that ran before any such dependency in the pass's own order keep their outcome, the remainder are
+     * restored and run again in order.
+     */
     template<typename T>
-    void Algorithm<T>::pass4(std::vector<Record<T>> &na, std::vector<Record<T>> &oa) {
+    void Algorithm<T>::extend_blocks(const Direction &direction, Records &na, Records &oa,
+                                     const std::vector<size_t> &boundaries) {
 
-        size_t i = 0;
+        const auto segments = boundaries.size() - 1;
 
-        if (na.empty() || oa.empty()) {
+        // one step after another from the segment ranked `first` on, descending passes rank the segments top down
+        const auto run_in_order = [&](const size_t first) {
+
+            struct InOrder {
+
+                Records &oa;
+
+                bool claim(const size_t) const {
+                    return true;
+                }
+
+                void set_index(const size_t i, const size_t index) {
+                    oa.set_index(i, index);
+                }
+            } original {oa};
+
+            if (direction == Ascending) {
+
+                for (auto i = boundaries[first]; i < na.size(); i += 1) {
+                    find_unchanged_blocks(Ascending, i, na, oa, original);
+                }
+
+            } else {
+
+                const auto last = segments - 1 - first;
+
+                for (auto j = last + 1 < segments ? boundaries[last + 1] : na.size() - 1; j != 0; --j) {
+                    find_unchanged_blocks(Descending, j, na, oa, original);
+                }
+            }
+        };
+
+        if (segments == 1) {
+
+            run_in_order(0);
+
+            return;
+        }
+
+        const auto na_indexes = na.indexes;
+        const auto oa_indexes = oa.indexes;
+
+        std::unique_ptr<std::atomic<uint32_t>[]> owners(new std::atomic<uint32_t>[oa.size()]);
+
+        for (size_t i = 0; i < oa.size(); i += 1) {
+            owners[i].store(Records::Unmatched, std::memory_order_relaxed);
+        }
+
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> rewrites(segments);
+
+        // the lowest ranked segment whose outcome may depend on another's
+        std::atomic<size_t> dependent(segments);
+
+        run_segments(segments, [&](const size_t segment) {
+
+            const auto rank = direction == Ascending ? segment : segments - 1 - segment;
+
+            struct InSegment {
+
+                Records &oa;
+                const std::vector<uint32_t> &oa_indexes;
+                std::atomic<uint32_t> *owners;
+                std::vector<std::pair<uint32_t, uint32_t>> &rewrites;
+                const uint32_t rank;
+                std::atomic<size_t> &dependent;
+
+                bool claim(const size_t i) const {
+
+                    if (oa_indexes[i] != Records::Unmatched) {
+                        return true;
+                    }
+
+                    auto owner = Records::Unmatched;
+
+                    if (owners[i].compare_exchange_strong(owner, rank, std::memory_order_relaxed) || owner == rank) {
+                        return true;
+                    }
+
+                    // the segment stops short and is run again, along with the owner should it rank later
+                    auto lowest = dependent.load();
+
+                    while (rank < lowest && !dependent.compare_exchange_weak(lowest, rank)) {
+                    }
+
+                    return false;
+                }
+
+                void set_index(const size_t i, const size_t index) {
+
+                    if (oa_indexes[i] == Records::Unmatched) {
+                        oa.set_index(i, index);
+                    } else {
+                        rewrites.emplace_back(static_cast<uint32_t>(i), static_cast<uint32_t>(index));
+                    }
+                }
+            } original {oa, oa_indexes, owners.get(), rewrites[rank], static_cast<uint32_t>(rank), dependent};
+
+            const auto extend = [&](const size_t i) {
+                return dependent.load(std::memory_order_relaxed) >= rank
+                       && find_unchanged_blocks(direction, i, na, oa, original);
+            };
+
+            // a step onto the next segment's anchor would only restate its match, so it is skipped
+            if (direction == Ascending) {
+
+                const auto end = segment + 1 < segments ? boundaries[segment + 1] - 1 : na.size();
+
+                for (auto i = boundaries[segment]; i < end; i += 1) {
+
+                    if (!extend(i)) {
+                        return;
+                    }
+                }
+
+            } else {
+
+                const auto top = segment + 1 < segments ? boundaries[segment + 1] : na.size() - 1;
+                const auto bottom = segment > 0 ? boundaries[segment] + 2 : 1;
+
+                for (auto j = top; j >= bottom; j -= 1) {
+
+                    if (!extend(j)) {
+                        return;
+                    }
+                }
+            }
+        });
+
+        const auto first = dependent.load();
+
+        for (size_t rank = 0; rank < first; rank += 1) {
+
+            for (const auto &rewrite : rewrites[rank]) {
+                oa.indexes[rewrite.first] = rewrite.second;
+            }
+        }
+
+        if (first == segments) {
             return;
         }
 
-        for (const auto &record : na) {
+        for (size_t i = 0; i < oa.size(); i += 1) {
 
-            find_unchanged_blocks(record, Ascending, i, na, oa);
+            if (owners[i].load(std::memory_order_relaxed) != Records::Unmatched
+                && owners[i].load(std::memory_order_relaxed) >= first) {
+                oa.indexes[i] = oa_indexes[i];
+            }
+        }
 
-            i += 1;
+        // every new item the remaining segments can have changed, anchors included as they never change
+        if (direction == Ascending) {
+            std::copy(na_indexes.begin() + boundaries[first], na_indexes.end(), na.indexes.begin() + boundaries[first]);
+        } else {
+            std::copy(na_indexes.begin(), na_indexes.begin() + boundaries[segments - first], na.indexes.begin());
         }
+
+        run_in_order(first);
     }
 
-    //  Pass 5: Find descending connected blocks
+    // Pass 4: Find ascending connected blocks
     template<typename T>
-    void Algorithm<T>::pass5(std::vector<Record<T>> &na, std::vector<Record<T>> &oa) {
+    void Algorithm<T>::pass4(Records &na, Records &oa, const std::vector<size_t> &boundaries) {
 
         if (na.empty() || oa.empty()) {
             return;
         }
 
-        for (auto j = na.size()-1; j != 0; --j) {
+        extend_blocks(Ascending, na, oa, boundaries);
+    }
+
+    //  Pass 5: Find descending connected blocks
+    template<typename T>
+    void Algorithm<T>::pass5(Records &na, Records &oa, const std::vector<size_t> &boundaries) {
 
-            find_unchanged_blocks(na[j], Descending, j, na, oa);
+        if (na.empty() || oa.empty()) {
+            return;
         }
+
+        extend_blocks(Descending, na, oa, boundaries);
     }
 
     template<typename T>
-    std::vector<T> Algorithm<T>::populate_deleted_items(const std::vector<Record<T>> &oa) {
-
-        std::vector<T> deleted;
+    Changes<T>::Changes(Records &&na, Records &&oa, std::vector<Entry> &&entries, const std::vector<T> &updated,
+                        const PreparedBaseline<T> &baseline)
+            : na(std::move(na)), oa(std::move(oa)), entries(std::move(entries)),
+              updated(&updated), baseline(&baseline) {}
 
-        // keep track of the number of times an item is deleted. Use this count to avoid deleting duplicates.
-        std::vector<size_t> counter(oa.size(), 0);
+    template<typename T>
+    bool Changes<T>::is(const Category category, const size_t i) const {
 
-        for (const auto &record : oa) {
+        switch (category) {
 
-            const auto &entry = record.entry;
+            case Inserted:
+                return na.indexes[i] == Records::Unmatched;
 
-            const auto &old_index = entry->all_old_indexes.top();
+            case Unchanged:
+                return na.indexes[i] != Records::Unmatched && na.equals(i, oa, i);
 
-            if (old_index == NotFound) {
-                continue;
-            }
+            case Moved:
+                return na.indexes[i] != Records::Unmatched && !na.equals(i, oa, i)
+                       && na.entries[i] == oa.entries[na.indexes[i]];
 
-            counter[old_index] += 1;
+            case Deleted: {
 
-            const auto &record_count = counter[old_index];
+                /*
+                 * Pass 3 pairs an entry's first nc old occurrences with new ones, so only the old occurrences past
+                 * those are deleted. The old indexes are ascending, making that a comparison against the nc-th.
+                 */
+                const auto &entry = entries[oa.entries[i]];
 
-            if (record_count > entry->nc || entry->nc == 0) {
-                deleted.push_back(record.value);
+                return entry.nc < entry.oc && i >= entry.all_old_indexes[entry.nc];
             }
         }
 
-        return deleted;
+        return false;
     }
 
     template<typename T>
-    auto Algorithm<T>::populate_new_items(const std::vector<Record<T>> &na, const std::vector<Record<T>> &oa) {
+    T Changes<T>::value(const Category category, const size_t i) const {
 
-        std::vector<T> inserted, moved, unchanged;
+        return category == Deleted ? baseline->value(i) : (*updated)[i];
+    }
 
-        size_t i = 0;
+    template<typename T>
+    std::vector<Alignment> Changes<T>::alignments() const {
 
-        for (const auto &record : na) {
+        std::vector<Alignment> alignments(na.size());
 
-            if (record.index() == NotFound) {
+        for (size_t i = 0; i < na.size(); i += 1) {
 
-                inserted.push_back(record.value);
+            if (na.index(i) != NotFound) {
 
-            } else {
+                alignments[i].old_index = na.index(i);
+                alignments[i].unchanged = na.equals(i, oa, i);
+            }
+        }
 
-                if (record == oa[i]) {
+        return alignments;
+    }
 
-                    unchanged.push_back(record.value);
+    template<typename T>
+    const std::unordered_map<std::string, std::vector<T>> Algorithm<T>::pass6(const Changes<T> &changes,
+                                                                             const size_t segments) {
 
-                } else if (record.entry == oa[record.index()].entry) {
+        using Iterator = typename Changes<T>::Iterator;
 
-                    moved.push_back(record.value);
-                }
-            }
+        // each segment reads its slice of every category, the slices are joined in order
+        std::vector<std::vector<std::vector<T>>> categories(4, std::vector<std::vector<T>>(segments));
 
-            i += 1;
-        }
+        run_segments(segments, [&](const size_t segment) {
 
-        return std::make_tuple(inserted, moved, unchanged);
-    }
+            for (const auto category : {Changes<T>::Inserted, Changes<T>::Moved, Changes<T>::Unchanged,
+                                        Changes<T>::Deleted}) {
 
-    template<typename T>
-    const std::unordered_map<std::string, std::vector<T>> Algorithm<T>::pass6(std::vector<Record<T>> &na,
-                                                                        std::vector<Record<T>> &oa) {
+                const auto size = changes.side_size(category);
+                const auto end = (segment + 1) * size / segments;
 
-        const auto updates = populate_new_items(na, oa);
-        const auto deleted = populate_deleted_items(oa);
+                categories[category][segment].assign(Iterator(&changes, category, segment * size / segments, end),
+                                                     Iterator(&changes, category, end, end));
+            }
+        });
 
         const std::unordered_map<std::string, std::vector<T>> results {
-                {INSERTED,  std::get<0>(updates)},
-                {MOVED,     std::get<1>(updates)},
-                {UNCHANGED, std::get<2>(updates)},
-                {DELETED,   deleted}
+                {INSERTED,  joined(categories[Changes<T>::Inserted])},
+                {MOVED,     joined(categories[Changes<T>::Moved])},
+                {UNCHANGED, joined(categories[Changes<T>::Unchanged])},
+                {DELETED,   joined(categories[Changes<T>::Deleted])}
         };
 
         return results;
     }
 
+    template class Changes<std::string>;
     template class Algorithm<std::string>;
-    template struct Record<std::string>;
 
+    template class Changes<size_t>;
     template class Algorithm<size_t>;
-    template struct Record<size_t>;
 
+    template class Changes<uint32_t>;
     template class Algorithm<uint32_t>;
-    template struct Record<uint32_t>;
 
 }  // namespace HeckelDiff
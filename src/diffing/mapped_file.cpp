@@ -0,0 +1,112 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HECKEL_DIFF_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace HeckelDiff {
+
+    MappedFile::MappedFile() {}
+
+    MappedFile::~MappedFile() {
+
+#ifdef HECKEL_DIFF_MMAP
+        if (buffer.empty() && address != nullptr) {
+            munmap(const_cast<void *>(address), length);
+        }
+#endif
+    }
+
+#ifdef HECKEL_DIFF_MMAP
+
+    std::unique_ptr<MappedFile> MappedFile::open(const std::string &path) {
+
+        const auto descriptor = ::open(path.c_str(), O_RDONLY);
+
+        if (descriptor < 0) {
+            throw std::runtime_error("unable to open baseline " + path);
+        }
+
+        struct stat status {};
+
+        if (fstat(descriptor, &status) != 0 || status.st_size <= 0 || status.st_size % sizeof(uint64_t) != 0) {
+
+            close(descriptor);
+            throw std::runtime_error("malformed baseline " + path);
+        }
+
+        const auto length = static_cast<size_t>(status.st_size);
+        const auto address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+        close(descriptor);
+
+        if (address == MAP_FAILED) {
+            throw std::runtime_error("unable to map baseline " + path);
+        }
+
+        std::unique_ptr<MappedFile> file(new MappedFile());
+
+        file->address = address;
+        file->length = length;
+
+        return file;
+    }
+
+#else
+
+    std::unique_ptr<MappedFile> MappedFile::open(const std::string &path) {
+
+        std::ifstream stream(path, std::ios::binary | std::ios::ate);
+
+        if (!stream) {
+            throw std::runtime_error("unable to open baseline " + path);
+        }
+
+        const auto length = static_cast<std::streamoff>(stream.tellg());
+
+        if (length <= 0 || length % sizeof(uint64_t) != 0) {
+            throw std::runtime_error("malformed baseline " + path);
+        }
+
+        std::unique_ptr<MappedFile> file(new MappedFile());
+
+        file->buffer.resize(static_cast<size_t>(length) / sizeof(uint64_t));
+
+        stream.seekg(0);
+        stream.read(reinterpret_cast<char *>(file->buffer.data()), length);
+
+        if (!stream) {
+            throw std::runtime_error("unable to read baseline " + path);
+        }
+
+        file->address = file->buffer.data();
+        file->length = static_cast<size_t>(length);
+
+        return file;
+    }
+
+#endif
+
+    const uint64_t *MappedFile::words() const {
+        return static_cast<const uint64_t *>(address);
+    }
+
+    size_t MappedFile::word_count() const {
+        return length / sizeof(uint64_t);
+    }
+
+}  // namespace HeckelDiff
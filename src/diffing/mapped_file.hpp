@@ -0,0 +1,40 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef MappedFile_H
+#define MappedFile_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace HeckelDiff {
+
+    /*
+     * A file of 64 bit words, read only. Mapped into memory where the platform has mmap, otherwise read into a
+     * buffer, so the rest of the library stays standard C++.
+     */
+    class MappedFile final {
+
+        const void *address = nullptr;
+        size_t length = 0;
+        std::vector<uint64_t> buffer;
+
+        MappedFile();
+
+    public:
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        ~MappedFile();
+
+        // Throws std::runtime_error if the file is missing, empty or not a whole number of words.
+        static std::unique_ptr<MappedFile> open(const std::string &path);
+
+        const uint64_t *words() const;
+        size_t word_count() const;
+    };
+}
+
+#endif //MappedFile_H
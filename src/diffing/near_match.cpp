@@ -0,0 +1,197 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include "../include/near_match.hpp"
+#include "hashing.hpp"
+#include <bitset>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HeckelDiff {
+
+    namespace {
+
+        const size_t FingerprintBits = 64;
+
+        // The bits each table samples, the same for every run.
+        std::vector<std::vector<size_t>> sampled_bits(const size_t tables, const size_t bits) {
+
+            std::vector<std::vector<size_t>> sampled(tables);
+            uint64_t seed = 0;
+
+            for (auto &positions : sampled) {
+
+                uint64_t chosen = 0;
+
+                while (positions.size() < bits) {
+
+                    seed += 0x9e3779b97f4a7c15;
+
+                    const auto bit = mix_bits(seed) % FingerprintBits;
+
+                    if ((chosen >> bit & 1) == 0) {
+                        chosen |= static_cast<uint64_t>(1) << bit;
+                        positions.push_back(bit);
+                    }
+                }
+            }
+
+            return sampled;
+        }
+
+        uint64_t key_of(const uint64_t fingerprint, const std::vector<size_t> &positions) {
+
+            uint64_t key = 0;
+
+            for (const auto bit : positions) {
+                key = key << 1 | (fingerprint >> bit & 1);
+            }
+
+            return key;
+        }
+    }  // namespace
+
+    NearMatcher::NearMatcher(const NearMatchOptions &options) : options(options) {
+
+        if (options.shingle_size == 0 || !(options.threshold >= 0.0 && options.threshold <= 1.0)
+            || options.tables == 0 || options.sampled_bits == 0 || options.sampled_bits > FingerprintBits
+            || options.bucket_size == 0) {
+
+            throw std::invalid_argument("near match options need a shingle, a threshold in [0, 1], a table, "
+                                        "1 to 64 sampled bits and room in a bucket");
+        }
+    }
+
+    // SimHash: every shingle votes on each bit, the fingerprint keeps the majority.
+    uint64_t NearMatcher::fingerprint(const std::string &item, const size_t shingle_size) {
+
+        int votes[FingerprintBits] = {};
+
+        const auto vote = [&votes](const uint64_t hash) {
+
+            for (size_t bit = 0; bit < FingerprintBits; bit += 1) {
+                votes[bit] += (hash >> bit) & 1 ? 1 : -1;
+            }
+        };
+
+        // an item shorter than a shingle is its own shingle
+        if (item.size() <= shingle_size) {
+
+            vote(mix_bits(fnv1a(item.data(), item.size())));
+
+        } else {
+
+            for (size_t i = 0; i + shingle_size <= item.size(); i += 1) {
+                vote(mix_bits(fnv1a(item.data() + i, shingle_size)));
+            }
+        }
+
+        uint64_t fingerprint = 0;
+
+        for (size_t bit = 0; bit < FingerprintBits; bit += 1) {
+
+            if (votes[bit] > 0) {
+                fingerprint |= static_cast<uint64_t>(1) << bit;
+            }
+        }
+
+        return fingerprint;
+    }
+
+    double NearMatcher::similarity(const uint64_t a, const uint64_t b) {
+
+        return 1.0 - static_cast<double>(std::bitset<FingerprintBits>(a ^ b).count()) / FingerprintBits;
+    }
+
+    std::vector<MovedModified> NearMatcher::match(const Changes<std::string> &changes) const {
+
+        std::vector<size_t> deleted_at;
+        std::vector<uint64_t> deleted_fingerprints;
+
+        const auto sampled = sampled_bits(options.tables, options.sampled_bits);
+
+        // from the sampled bits to the deleted items holding them
+        std::vector<std::unordered_map<uint64_t, std::vector<uint32_t>>> buckets(options.tables);
+
+        for (auto it = changes.deleted().begin(); it != changes.deleted().end(); ++it) {
+
+            const auto item = static_cast<uint32_t>(deleted_at.size());
+            const auto print = fingerprint(*it, options.shingle_size);
+
+            deleted_at.push_back(it.index());
+            deleted_fingerprints.push_back(print);
+
+            for (size_t table = 0; table < options.tables; table += 1) {
+
+                auto &bucket = buckets[table][key_of(print, sampled[table])];
+
+                if (bucket.size() < options.bucket_size) {
+                    bucket.push_back(item);
+                }
+            }
+        }
+
+        std::vector<bool> paired(deleted_at.size(), false);
+        std::vector<MovedModified> result;
+
+        if (deleted_at.empty()) {
+            return result;
+        }
+
+        for (auto it = changes.inserted().begin(); it != changes.inserted().end(); ++it) {
+
+            const auto print = fingerprint(*it, options.shingle_size);
+
+            auto best = NotFound;
+            auto best_similarity = 0.0;
+
+            for (size_t table = 0; table < options.tables; table += 1) {
+
+                const auto bucket = buckets[table].find(key_of(print, sampled[table]));
+
+                if (bucket == buckets[table].end()) {
+                    continue;
+                }
+
+                for (const auto candidate : bucket->second) {
+
+                    if (paired[candidate]) {
+                        continue;
+                    }
+
+                    const auto candidate_similarity = similarity(print, deleted_fingerprints[candidate]);
+
+                    // ties go to the earliest deleted item, whichever table offered it
+                    if (candidate_similarity < options.threshold || candidate_similarity < best_similarity
+                        || (candidate_similarity == best_similarity && candidate >= best)) {
+                        continue;
+                    }
+
+                    best = candidate;
+                    best_similarity = candidate_similarity;
+                }
+            }
+
+            if (best == NotFound) {
+                continue;
+            }
+
+            paired[best] = true;
+
+            MovedModified pair;
+
+            pair.old_index = deleted_at[best];
+            pair.new_index = it.index();
+            pair.similarity = best_similarity;
+
+            result.push_back(pair);
+        }
+
+        return result;
+    }
+
+}  // namespace HeckelDiff
@@ -0,0 +1,681 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include "../include/prepared_baseline.hpp"
+#include "hashing.hpp"
+#include "direct_table.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <memory>
+
+namespace HeckelDiff {
+
+    namespace {
+
+        const uint64_t Magic = 0x31455341424c4b48;  // "HKLBASE1"
+        const uint64_t Version = 2;
+
+        enum HeaderWord {
+            MagicWord,
+            VersionWord,
+            KindWord,
+            WidthWord,
+            ItemCountWord,
+            SymbolCountWord,
+            SlotCountWord,
+            BlobBytesWord,
+            DirectMinWord,
+            DirectSlotsWord,
+            HeaderWords
+        };
+
+        enum SymbolWord {
+            HashWord,
+            OccurrencesWord,
+            FirstWord,
+            SymbolWords
+        };
+
+        enum ValueKind {
+            IntegralValue,
+            StringValue
+        };
+
+        size_t slot_count_for(const size_t count) {
+
+            size_t slots = 1;
+
+            while (slots < count * 2) {
+                slots <<= 1;
+            }
+
+            return slots;
+        }
+
+        // Moves `at` past `count` records of `width` words, false when that would pass `end`.
+        bool skip(uint64_t &at, const uint64_t count, const uint64_t width, const uint64_t end) {
+
+            if (count > (end - at) / width) {
+                return false;
+            }
+
+            at += count * width;
+
+            return true;
+        }
+
+        template<typename T>
+        struct ValueCodec {
+
+            static const uint64_t kind = IntegralValue;
+
+            // std::hash is free to change between builds, the image has to outlive them.
+            static uint64_t hash(const T &value) {
+                return mix_bits(static_cast<uint64_t>(value));
+            }
+
+            static size_t blob_bytes(const std::vector<const T *> &) {
+                return 0;
+            }
+
+            static size_t words(const size_t symbol_count, const size_t) {
+                return symbol_count;
+            }
+
+            static void encode(const std::vector<const T *> &values, uint64_t *out) {
+
+                for (const auto &value : values) {
+                    *out++ = static_cast<uint64_t>(*value);
+                }
+            }
+
+            static bool equals(const uint64_t *values, const size_t, const size_t symbol, const T &item) {
+                return values[symbol] == static_cast<uint64_t>(item);
+            }
+
+            static T decode(const uint64_t *values, const size_t, const size_t symbol) {
+                return static_cast<T>(values[symbol]);
+            }
+
+            static bool valid(const uint64_t *, const size_t, const uint64_t blob_bytes) {
+                return blob_bytes == 0;
+            }
+
+            // Slot of `value` in a direct table starting at `min`, values below it wrap past the end.
+            static uint64_t offset(const T &value, const uint64_t min) {
+                return static_cast<uint64_t>(value) - min;
+            }
+        };
+
+        template<>
+        struct ValueCodec<std::string> {
+
+            static const uint64_t kind = StringValue;
+
+            static uint64_t hash(const std::string &value) {
+                return mix_bits(fnv1a(value.data(), value.size()));
+            }
+
+            static size_t blob_bytes(const std::vector<const std::string *> &values) {
+
+                size_t bytes = 0;
+
+                for (const auto &value : values) {
+                    bytes += value->size();
+                }
+
+                return bytes;
+            }
+
+            static size_t words(const size_t symbol_count, const size_t blob_bytes) {
+                return symbol_count + 1 + blob_bytes / sizeof(uint64_t) + (blob_bytes % sizeof(uint64_t) != 0);
+            }
+
+            static void encode(const std::vector<const std::string *> &values, uint64_t *out) {
+
+                auto blob = reinterpret_cast<char *>(out + values.size() + 1);
+                uint64_t offset = 0;
+
+                for (const auto &value : values) {
+
+                    *out++ = offset;
+                    std::memcpy(blob + offset, value->data(), value->size());
+                    offset += value->size();
+                }
+
+                *out = offset;
+            }
+
+            static bool equals(const uint64_t *values, const size_t symbol_count, const size_t symbol,
+                               const std::string &item) {
+
+                const auto length = values[symbol + 1] - values[symbol];
+
+                if (length != item.size()) {
+                    return false;
+                }
+
+                auto blob = reinterpret_cast<const char *>(values + symbol_count + 1);
+
+                return std::memcmp(blob + values[symbol], item.data(), length) == 0;
+            }
+
+            static std::string decode(const uint64_t *values, const size_t symbol_count, const size_t symbol) {
+
+                auto blob = reinterpret_cast<const char *>(values + symbol_count + 1);
+
+                return std::string(blob + values[symbol], values[symbol + 1] - values[symbol]);
+            }
+
+            // the blob offsets start at 0, never decrease and end at the blob size
+            static bool valid(const uint64_t *values, const size_t symbol_count, const uint64_t blob_bytes) {
+
+                if (values[0] != 0 || values[symbol_count] != blob_bytes) {
+                    return false;
+                }
+
+                for (size_t symbol = 0; symbol < symbol_count; symbol += 1) {
+
+                    if (values[symbol + 1] < values[symbol]) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            // strings are always hashed
+            static uint64_t offset(const std::string &, const uint64_t) {
+                return std::numeric_limits<uint64_t>::max();
+            }
+        };
+
+        /*
+         * Whether every index in a mapped image stays inside it: each symbol owns the next `oc` old indexes, which
+         * ascend and point back at positions holding that symbol, and the slots and direct table only name symbols
+         * that exist. Also leaves the hash table an empty slot, so probing ends.
+         */
+        bool valid_indexes(const uint64_t *symbols, const uint64_t symbol_count, const uint64_t item_count,
+                           const uint64_t *slots, const uint64_t slot_count, const uint64_t *old_indexes,
+                           const uint64_t *positions, const uint32_t *direct, const uint64_t direct_slots) {
+
+            uint64_t first = 0;
+
+            for (uint64_t symbol = 0; symbol < symbol_count; symbol += 1) {
+
+                const auto record = symbols + symbol * SymbolWords;
+                const auto oc = record[OccurrencesWord];
+
+                if (record[FirstWord] != first || oc == 0 || oc > item_count - first) {
+                    return false;
+                }
+
+                for (uint64_t i = first; i < first + oc; i += 1) {
+
+                    const auto old_index = old_indexes[i];
+
+                    if (old_index >= item_count || positions[old_index] != symbol
+                        || (i > first && old_index <= old_indexes[i - 1])) {
+                        return false;
+                    }
+                }
+
+                first += oc;
+            }
+
+            if (first != item_count) {
+                return false;
+            }
+
+            // listing every old index once leaves every position naming a symbol, the tables still need checking
+            uint64_t filled = 0;
+
+            for (uint64_t slot = 0; slot < slot_count; slot += 1) {
+
+                if (slots[slot] > symbol_count) {
+                    return false;
+                }
+
+                filled += slots[slot] != 0;
+            }
+
+            for (uint64_t slot = 0; slot < direct_slots; slot += 1) {
+
+                if (direct[slot] > symbol_count) {
+                    return false;
+                }
+            }
+
+            return filled <= symbol_count;
+        }
+
+        /*
+         * Pass 2 for dense integral originals: a table indexed by value - min gives each item its symbol without
+         * hashing it. The table, symbol id + 1 per value and 0 for none, is kept for `find`.
+         */
+        template<typename T>
+        bool assign_symbols_directly(const std::vector<T> &original, std::vector<uint64_t> &hashes,
+                                     std::vector<uint64_t> &occurrences, std::vector<const T *> &values,
+                                     std::vector<uint64_t> &positions, std::vector<uint32_t> &direct,
+                                     uint64_t &direct_min, std::true_type) {
+
+            T min;
+            uint64_t slots;
+
+            if (original.size() >= std::numeric_limits<uint32_t>::max() || !fits_direct_table(original, min, slots)) {
+                return false;
+            }
+
+            direct.assign(slots, 0);
+            direct_min = static_cast<uint64_t>(min);
+
+            // no more symbols than items or values
+            const auto most = std::min(static_cast<uint64_t>(original.size()), slots);
+
+            hashes.reserve(most);
+            occurrences.reserve(most);
+            values.reserve(most);
+
+            for (size_t i = 0; i < original.size(); i += 1) {
+
+                const auto &item = original[i];
+                auto &slot = direct[ValueCodec<T>::offset(item, direct_min)];
+
+                if (slot == 0) {
+
+                    slot = static_cast<uint32_t>(hashes.size() + 1);
+
+                    hashes.push_back(ValueCodec<T>::hash(item));
+                    occurrences.push_back(0);
+                    values.push_back(&item);
+                }
+
+                occurrences[slot - 1] += 1;
+                positions[i] = slot - 1;
+            }
+
+            return true;
+        }
+
+        template<typename T>
+        bool assign_symbols_directly(const std::vector<T> &, std::vector<uint64_t> &, std::vector<uint64_t> &,
+                                     std::vector<const T *> &, std::vector<uint64_t> &, std::vector<uint32_t> &,
+                                     uint64_t &, std::false_type) {
+            return false;
+        }
+    }  // namespace
+
+    template<typename T>
+    struct PreparedBaseline<T>::Scratch final {
+
+        std::vector<uint64_t> hashes;
+        std::vector<uint64_t> occurrences;
+        std::vector<const T *> values;
+        std::vector<uint64_t> positions;
+        std::vector<uint64_t> build_slots;
+        std::vector<uint32_t> direct;
+    };
+
+    template<typename T>
+    const size_t PreparedBaseline<T>::NoSymbol;
+
+    template<typename T>
+    PreparedBaseline<T>::PreparedBaseline() {}
+
+    template<typename T>
+    PreparedBaseline<T>::PreparedBaseline(PreparedBaseline &&other) noexcept = default;
+
+    template<typename T>
+    PreparedBaseline<T> &PreparedBaseline<T>::operator=(PreparedBaseline &&other) noexcept = default;
+
+    template<typename T>
+    PreparedBaseline<T>::~PreparedBaseline() = default;
+
+    template<typename T>
+    PreparedBaseline<T> PreparedBaseline<T>::prepare(const std::vector<T> &original) {
+
+        auto baseline = prepare(original, PreparedBaseline());
+
+        baseline.m_scratch.reset();
+
+        return baseline;
+    }
+
+    template<typename T>
+    PreparedBaseline<T> PreparedBaseline<T>::prepare(const std::vector<T> &original, PreparedBaseline &&recycled) {
+
+        const auto item_count = original.size();
+
+        PreparedBaseline<T> baseline;
+
+        baseline.m_storage = std::move(recycled.m_storage);
+        baseline.m_scratch = recycled.m_scratch ? std::move(recycled.m_scratch) : std::make_unique<Scratch>();
+
+        auto &hashes = baseline.m_scratch->hashes;
+        auto &occurrences = baseline.m_scratch->occurrences;
+        auto &values = baseline.m_scratch->values;
+        auto &positions = baseline.m_scratch->positions;
+        auto &direct = baseline.m_scratch->direct;
+
+        hashes.clear();
+        occurrences.clear();
+        values.clear();
+        direct.clear();
+        positions.assign(item_count, 0);
+
+        uint64_t direct_min = 0;
+
+        if (!assign_symbols_directly(original, hashes, occurrences, values, positions, direct, direct_min,
+                                     std::is_integral<T>())) {
+
+            // build against a table sized for the worst case, then size the stored table to the symbols found
+            const auto build_slot_count = slot_count_for(item_count);
+            const auto build_mask = build_slot_count - 1;
+            auto &build_slots = baseline.m_scratch->build_slots;
+
+            build_slots.assign(build_slot_count, 0);
+
+            for (size_t i = 0; i < item_count; i += 1) {
+
+                const auto &item = original[i];
+                const auto hash = ValueCodec<T>::hash(item);
+
+                auto slot = hash & build_mask;
+                size_t symbol;
+
+                while (true) {
+
+                    if (build_slots[slot] == 0) {
+
+                        symbol = hashes.size();
+
+                        hashes.push_back(hash);
+                        occurrences.push_back(0);
+                        values.push_back(&item);
+
+                        build_slots[slot] = symbol + 1;
+
+                        break;
+                    }
+
+                    symbol = build_slots[slot] - 1;
+
+                    if (hashes[symbol] == hash && *values[symbol] == item) {
+                        break;
+                    }
+
+                    slot = (slot + 1) & build_mask;
+                }
+
+                occurrences[symbol] += 1;
+                positions[i] = symbol;
+            }
+        }
+
+        const auto symbol_count = hashes.size();
+        const auto slot_count = slot_count_for(symbol_count);
+        const auto mask = slot_count - 1;
+        const auto blob_bytes = ValueCodec<T>::blob_bytes(values);
+
+        const auto symbols_at = static_cast<size_t>(HeaderWords);
+        const auto slots_at = symbols_at + symbol_count * SymbolWords;
+        const auto old_indexes_at = slots_at + slot_count;
+        const auto positions_at = old_indexes_at + item_count;
+        const auto values_at = positions_at + item_count;
+        const auto direct_at = values_at + ValueCodec<T>::words(symbol_count, blob_bytes);
+        const auto word_count = direct_at + (direct.size() + 1) / 2;
+
+        auto &words = baseline.m_storage;
+
+        words.assign(word_count, 0);
+
+        words[MagicWord] = Magic;
+        words[VersionWord] = Version;
+        words[KindWord] = ValueCodec<T>::kind;
+        words[WidthWord] = sizeof(T);
+        words[ItemCountWord] = item_count;
+        words[SymbolCountWord] = symbol_count;
+        words[SlotCountWord] = slot_count;
+        words[BlobBytesWord] = blob_bytes;
+        words[DirectMinWord] = direct_min;
+        words[DirectSlotsWord] = direct.size();
+
+        uint64_t first = 0;
+
+        for (size_t symbol = 0; symbol < symbol_count; symbol += 1) {
+
+            auto record = &words[symbols_at + symbol * SymbolWords];
+
+            record[HashWord] = hashes[symbol];
+            record[OccurrencesWord] = occurrences[symbol];
+            record[FirstWord] = first;
+
+            first += occurrences[symbol];
+
+            auto slot = hashes[symbol] & mask;
+
+            while (words[slots_at + slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+
+            words[slots_at + slot] = symbol + 1;
+        }
+
+        // walking forwards keeps each symbol's old indexes ascending, the counts are done with and become cursors
+        auto &cursor = occurrences;
+
+        for (size_t symbol = 0; symbol < symbol_count; symbol += 1) {
+            cursor[symbol] = words[symbols_at + symbol * SymbolWords + FirstWord];
+        }
+
+        for (size_t i = 0; i < item_count; i += 1) {
+
+            const auto symbol = positions[i];
+
+            words[old_indexes_at + cursor[symbol]] = i;
+            cursor[symbol] += 1;
+
+            words[positions_at + i] = symbol;
+        }
+
+        ValueCodec<T>::encode(values, words.data() + values_at);
+
+        if (!direct.empty()) {
+            std::memcpy(words.data() + direct_at, direct.data(), direct.size() * sizeof(uint32_t));
+        }
+
+        baseline.bind(words.data(), words.size());
+
+        return baseline;
+    }
+
+    template<typename T>
+    PreparedBaseline<T> PreparedBaseline<T>::map(const std::string &path, const bool verify) {
+
+        auto mapping = MappedFile::open(path);
+
+        PreparedBaseline<T> baseline;
+
+        baseline.bind(mapping->words(), mapping->word_count());
+
+        if (verify) {
+            baseline.check_body();
+        }
+        baseline.m_mapping = std::move(mapping);
+
+        return baseline;
+    }
+
+    template<typename T>
+    void PreparedBaseline<T>::write(const std::string &path) const {
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char *>(m_words), m_word_count * sizeof(uint64_t));
+        file.close();
+
+        if (!file) {
+            throw std::runtime_error("unable to write baseline " + path);
+        }
+    }
+
+    template<typename T>
+    void PreparedBaseline<T>::bind(const uint64_t *words, const size_t word_count) {
+
+        if (word_count < HeaderWords
+            || words[MagicWord] != Magic
+            || words[VersionWord] != Version
+            || words[KindWord] != ValueCodec<T>::kind
+            || words[WidthWord] != sizeof(T)) {
+
+            throw std::runtime_error("baseline does not match this Algorithm");
+        }
+
+        const auto item_count = words[ItemCountWord];
+        const auto symbol_count = words[SymbolCountWord];
+        const auto slot_count = words[SlotCountWord];
+        const auto blob_bytes = words[BlobBytesWord];
+        const auto direct_slots = words[DirectSlotsWord];
+
+        // each section is checked to fit before the next is placed, so crafted counts cannot wrap the layout around
+        uint64_t at = HeaderWords;
+
+        const auto symbols_at = at;
+        auto fits = skip(at, symbol_count, SymbolWords, word_count);
+
+        const auto slots_at = at;
+        fits = fits && skip(at, slot_count, 1, word_count);
+
+        const auto old_indexes_at = at;
+        fits = fits && skip(at, item_count, 1, word_count);
+
+        const auto positions_at = at;
+        fits = fits && skip(at, item_count, 1, word_count);
+
+        const auto values_at = at;
+        fits = fits && blob_bytes / sizeof(uint64_t) < word_count
+               && skip(at, ValueCodec<T>::words(symbol_count, blob_bytes), 1, word_count);
+
+        const auto direct_at = at;
+        fits = fits && skip(at, direct_slots / 2 + direct_slots % 2, 1, word_count);
+
+        if (!fits || at != word_count
+            || slot_count == 0 || (slot_count & (slot_count - 1)) != 0 || slot_count / 2 < symbol_count) {
+
+            throw std::runtime_error("baseline is truncated or corrupt");
+        }
+
+        m_words = words;
+        m_word_count = word_count;
+
+        m_symbols = words + symbols_at;
+        m_slots = words + slots_at;
+        m_old_indexes = words + old_indexes_at;
+        m_positions = words + positions_at;
+        m_values = words + values_at;
+        m_direct = reinterpret_cast<const uint32_t *>(words + direct_at);
+    }
+
+    template<typename T>
+    void PreparedBaseline<T>::check_body() const {
+
+        const auto symbols = symbol_count();
+
+        if (!valid_indexes(m_symbols, symbols, size(), m_slots, m_words[SlotCountWord], m_old_indexes, m_positions,
+                           m_direct, m_words[DirectSlotsWord])
+            || !ValueCodec<T>::valid(m_values, symbols, m_words[BlobBytesWord])) {
+
+            throw std::runtime_error("baseline is corrupt");
+        }
+    }
+
+    template<typename T>
+    bool PreparedBaseline<T>::value_equals(const size_t symbol, const T &item) const {
+        return ValueCodec<T>::equals(m_values, symbol_count(), symbol, item);
+    }
+
+    template<typename T>
+    size_t PreparedBaseline<T>::size() const {
+        return m_words[ItemCountWord];
+    }
+
+    template<typename T>
+    size_t PreparedBaseline<T>::symbol_count() const {
+        return m_words[SymbolCountWord];
+    }
+
+    template<typename T>
+    size_t PreparedBaseline<T>::find(const T &item) const {
+
+        const auto direct_slots = m_words[DirectSlotsWord];
+
+        if (direct_slots != 0) {
+
+            const auto offset = ValueCodec<T>::offset(item, m_words[DirectMinWord]);
+
+            return offset < direct_slots && m_direct[offset] != 0 ? m_direct[offset] - 1 : NoSymbol;
+        }
+
+        const auto hash = ValueCodec<T>::hash(item);
+        const auto mask = m_words[SlotCountWord] - 1;
+
+        auto slot = hash & mask;
+
+        while (m_slots[slot] != 0) {
+
+            const auto symbol = m_slots[slot] - 1;
+
+            if (m_symbols[symbol * SymbolWords + HashWord] == hash && value_equals(symbol, item)) {
+                return symbol;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+
+        return NoSymbol;
+    }
+
+    template<typename T>
+    uint64_t PreparedBaseline<T>::hash(const T &item) {
+        return ValueCodec<T>::hash(item);
+    }
+
+    template<typename T>
+    uint64_t PreparedBaseline<T>::symbol_hash(const size_t symbol) const {
+        return m_symbols[symbol * SymbolWords + HashWord];
+    }
+
+    template<typename T>
+    size_t PreparedBaseline<T>::symbol_at(const size_t old_index) const {
+        return m_positions[old_index];
+    }
+
+    template<typename T>
+    size_t PreparedBaseline<T>::occurrences(const size_t symbol) const {
+        return m_symbols[symbol * SymbolWords + OccurrencesWord];
+    }
+
+    template<typename T>
+    const uint64_t *PreparedBaseline<T>::old_indexes(const size_t symbol) const {
+        return m_old_indexes + m_symbols[symbol * SymbolWords + FirstWord];
+    }
+
+    template<typename T>
+    T PreparedBaseline<T>::value(const size_t old_index) const {
+        return ValueCodec<T>::decode(m_values, symbol_count(), symbol_at(old_index));
+    }
+
+    template class PreparedBaseline<std::string>;
+    template class PreparedBaseline<size_t>;
+    template class PreparedBaseline<uint32_t>;
+
+}  // namespace HeckelDiff
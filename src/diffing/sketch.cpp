@@ -0,0 +1,110 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include "../include/sketch.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace HeckelDiff {
+
+    namespace {
+
+        // Keeps the `size` smallest distinct hashes seen so far.
+        void keep_smallest(std::set<uint64_t> &smallest, const uint64_t hash, const size_t size) {
+
+            if (smallest.size() == size && hash >= *smallest.rbegin()) {
+                return;
+            }
+
+            smallest.insert(hash);
+
+            if (smallest.size() > size) {
+                smallest.erase(std::prev(smallest.end()));
+            }
+        }
+    }  // namespace
+
+    template<typename T>
+    const size_t Sketch<T>::DefaultSize;
+
+    template<typename T>
+    Sketch<T>::Sketch(std::vector<uint64_t> &&hashes, const size_t size) : m_hashes(std::move(hashes)), m_size(size) {}
+
+    template<typename T>
+    Sketch<T> Sketch<T>::of(const std::vector<T> &items, const size_t size) {
+
+        std::set<uint64_t> smallest;
+
+        if (size > 0) {
+
+            for (const auto &item : items) {
+                keep_smallest(smallest, PreparedBaseline<T>::hash(item), size);
+            }
+        }
+
+        return Sketch<T>(std::vector<uint64_t>(smallest.begin(), smallest.end()), size);
+    }
+
+    template<typename T>
+    Sketch<T> Sketch<T>::of(const PreparedBaseline<T> &baseline, const size_t size) {
+
+        std::set<uint64_t> smallest;
+
+        if (size > 0) {
+
+            for (size_t symbol = 0; symbol < baseline.symbol_count(); symbol += 1) {
+                keep_smallest(smallest, baseline.symbol_hash(symbol), size);
+            }
+        }
+
+        return Sketch<T>(std::vector<uint64_t>(smallest.begin(), smallest.end()), size);
+    }
+
+    template<typename T>
+    double Sketch<T>::similarity(const Sketch &other) const {
+
+        if (m_hashes.empty() && other.m_hashes.empty()) {
+            return 1.0;
+        }
+
+        // the smallest hashes of the union, counting those both sketches hold
+        const auto size = std::min(m_size, other.m_size);
+
+        size_t i = 0;
+        size_t j = 0;
+        size_t taken = 0;
+        size_t shared = 0;
+
+        while (taken < size && (i < m_hashes.size() || j < other.m_hashes.size())) {
+
+            if (j == other.m_hashes.size() || (i < m_hashes.size() && m_hashes[i] < other.m_hashes[j])) {
+
+                i += 1;
+
+            } else if (i == m_hashes.size() || other.m_hashes[j] < m_hashes[i]) {
+
+                j += 1;
+
+            } else {
+
+                i += 1;
+                j += 1;
+                shared += 1;
+            }
+
+            taken += 1;
+        }
+
+        return taken == 0 ? 0.0 : static_cast<double>(shared) / taken;
+    }
+
+    template class Sketch<std::string>;
+    template class Sketch<size_t>;
+    template class Sketch<uint32_t>;
+
+}  // namespace HeckelDiff
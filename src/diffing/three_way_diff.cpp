@@ -0,0 +1,226 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include "../include/three_way_diff.hpp"
+#include <algorithm>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace HeckelDiff {
+
+    namespace {
+
+        /*
+         * Heckel matches items wherever they moved to. A merge can only keep matches that run the same way in both
+         * sequences, so take the longest run of matches whose base indexes increase along the side (patience sort).
+         * Returns the side index matched to each base index, NotFound for the rest.
+         */
+        std::vector<size_t> increasing_matches(const std::vector<Alignment> &alignments, const size_t base_size) {
+
+            std::vector<size_t> tails;
+            std::vector<size_t> previous(alignments.size(), NotFound);
+
+            for (size_t i = 0; i < alignments.size(); i += 1) {
+
+                const auto old_index = alignments[i].old_index;
+
+                if (old_index == NotFound) {
+                    continue;
+                }
+
+                const auto position = std::lower_bound(tails.begin(), tails.end(), old_index,
+                                                       [&alignments](const size_t tail, const size_t value) {
+                                                           return alignments[tail].old_index < value;
+                                                       });
+
+                if (position != tails.begin()) {
+                    previous[i] = *(position - 1);
+                }
+
+                if (position == tails.end()) {
+                    tails.push_back(i);
+                } else {
+                    *position = i;
+                }
+            }
+
+            std::vector<size_t> side_at(base_size, NotFound);
+
+            for (auto i = tails.empty() ? NotFound : tails.back(); i != NotFound; i = previous[i]) {
+                side_at[alignments[i].old_index] = i;
+            }
+
+            return side_at;
+        }
+
+        template<typename T>
+        bool equal_ranges(const std::vector<T> &side, const size_t side_begin, const size_t side_end,
+                          const std::vector<T> &other, const size_t other_begin, const size_t other_end) {
+
+            return side_end - side_begin == other_end - other_begin
+                   && std::equal(side.begin() + side_begin, side.begin() + side_end, other.begin() + other_begin);
+        }
+
+        template<typename T>
+        bool equals_base(const std::vector<T> &side, const size_t side_begin, const size_t side_end,
+                         const PreparedBaseline<T> &base, const size_t base_begin, const size_t base_end) {
+
+            if (side_end - side_begin != base_end - base_begin) {
+                return false;
+            }
+
+            for (size_t i = 0; i < side_end - side_begin; i += 1) {
+
+                if (base.symbol_at(base_begin + i) != base.find(side[side_begin + i])) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }  // namespace
+
+    template<typename T>
+    std::vector<typename ThreeWayAlgorithm<T>::Region> ThreeWayAlgorithm<T>::merge(const PreparedBaseline<T> &base,
+                                                                                 const std::vector<T> &ours,
+                                                                                 const std::vector<T> &theirs) {
+
+        std::vector<Alignment> ours_alignments;
+        std::vector<Alignment> theirs_alignments;
+
+        // both sides only read the base, so they can be matched against it at the same time
+        if (parallel) {
+
+            auto theirs_future = std::async(std::launch::async, [this, &base, &theirs] {
+                return theirs_algorithm.align(base, theirs);
+            });
+
+            ours_alignments = ours_algorithm.align(base, ours);
+            theirs_alignments = theirs_future.get();
+
+        } else {
+
+            ours_alignments = ours_algorithm.align(base, ours);
+            theirs_alignments = theirs_algorithm.align(base, theirs);
+        }
+
+        const auto ours_at = increasing_matches(ours_alignments, base.size());
+        const auto theirs_at = increasing_matches(theirs_alignments, base.size());
+
+        std::vector<Region> regions;
+
+        const auto append = [&regions](Region region) {
+
+            if (region.base_begin == region.base_end && region.ours_begin == region.ours_end
+                && region.theirs_begin == region.theirs_end) {
+                return;
+            }
+
+            if (!regions.empty() && regions.back().kind == Region::Unchanged && region.kind == Region::Unchanged) {
+
+                regions.back().base_end = region.base_end;
+                regions.back().ours_end = region.ours_end;
+                regions.back().theirs_end = region.theirs_end;
+
+                return;
+            }
+
+            regions.push_back(region);
+        };
+
+        Region region;
+
+        const auto close_region = [&](const size_t base_end, const size_t ours_end, const size_t theirs_end) {
+
+            region.base_end = base_end;
+            region.ours_end = ours_end;
+            region.theirs_end = theirs_end;
+
+            const auto ours_unchanged = equals_base(ours, region.ours_begin, ours_end,
+                                                    base, region.base_begin, base_end);
+            const auto theirs_unchanged = equals_base(theirs, region.theirs_begin, theirs_end,
+                                                      base, region.base_begin, base_end);
+
+            if (ours_unchanged && theirs_unchanged) {
+                region.kind = Region::Unchanged;
+            } else if (ours_unchanged) {
+                region.kind = Region::Theirs;
+            } else if (theirs_unchanged) {
+                region.kind = Region::Ours;
+            } else if (equal_ranges(ours, region.ours_begin, ours_end, theirs, region.theirs_begin, theirs_end)) {
+                region.kind = Region::Both;
+            } else {
+                region.kind = Region::Conflict;
+            }
+
+            append(region);
+        };
+
+        for (size_t b = 0; b < base.size(); b += 1) {
+
+            if (ours_at[b] == NotFound || theirs_at[b] == NotFound) {
+                continue;
+            }
+
+            // a stable item ends the region before it and is unchanged itself
+            close_region(b, ours_at[b], theirs_at[b]);
+
+            Region stable;
+
+            stable.base_begin = b;
+            stable.base_end = b + 1;
+            stable.ours_begin = ours_at[b];
+            stable.ours_end = ours_at[b] + 1;
+            stable.theirs_begin = theirs_at[b];
+            stable.theirs_end = theirs_at[b] + 1;
+
+            append(stable);
+
+            region = Region();
+            region.base_begin = b + 1;
+            region.ours_begin = ours_at[b] + 1;
+            region.theirs_begin = theirs_at[b] + 1;
+        }
+
+        close_region(base.size(), ours.size(), theirs.size());
+
+        return regions;
+    }
+
+    template<typename T>
+    bool ThreeWayAlgorithm<T>::resolve(const std::vector<Region> &regions, const std::vector<T> &ours,
+                                       const std::vector<T> &theirs, std::vector<T> &merged) {
+
+        merged.clear();
+
+        for (const auto &region : regions) {
+
+            switch (region.kind) {
+
+                case Region::Conflict:
+                    merged.clear();
+                    return false;
+
+                case Region::Theirs:
+                    merged.insert(merged.end(), theirs.begin() + region.theirs_begin,
+                                  theirs.begin() + region.theirs_end);
+                    break;
+
+                case Region::Unchanged:
+                case Region::Ours:
+                case Region::Both:
+                    merged.insert(merged.end(), ours.begin() + region.ours_begin, ours.begin() + region.ours_end);
+                    break;
+            }
+        }
+
+        return true;
+    }
+
+    template class ThreeWayAlgorithm<std::string>;
+    template class ThreeWayAlgorithm<size_t>;
+    template class ThreeWayAlgorithm<uint32_t>;
+
+}  // namespace HeckelDiff
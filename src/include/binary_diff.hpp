@@ -0,0 +1,68 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef BinaryDiff_H
+#define BinaryDiff_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "heckel_diff.hpp"
+#include "byte_range.hpp"
+
+namespace HeckelDiff {
+
+    static const std::string COPIED = "copied";
+    static const std::string LITERAL = "literal";
+
+    // Sizes in bytes. The average must be a power of two.
+    struct ChunkingOptions final {
+
+        size_t min_size = 2 * 1024;
+        size_t average_size = 8 * 1024;
+        size_t max_size = 64 * 1024;
+    };
+
+    struct Chunk final {
+
+        size_t offset = 0;
+        size_t length = 0;
+        uint64_t fingerprint = 0;
+    };
+
+    /*
+     * Splits blobs into content-defined chunks, so an insertion only disturbs the chunks around it, and runs the
+     * Heckel passes over the chunk fingerprints.
+     *
+     * Results cover the updated blob in order:
+     *  COPIED  | chunks the algorithm finds unchanged
+     *  MOVED   | chunks found elsewhere in the original
+     *  LITERAL | bytes that only exist in the update
+     */
+    class BinaryAlgorithm final {
+
+        ChunkingOptions options;
+        Algorithm<size_t> algorithm;
+
+    public:
+        // Throws std::invalid_argument if the chunk sizes are inconsistent.
+        explicit BinaryAlgorithm(const ChunkingOptions &options = ChunkingOptions());
+
+        // Throws std::invalid_argument if the chunk sizes are inconsistent.
+        static std::vector<Chunk> chunks(const uint8_t *data, size_t size, const ChunkingOptions &options);
+
+        std::unordered_map<std::string, std::vector<ByteRange>> diff(const uint8_t *original, size_t original_size,
+                                                                      const uint8_t *updated, size_t updated_size);
+
+        std::unordered_map<std::string, std::vector<ByteRange>> diff(const std::vector<uint8_t> &original,
+                                                                      const std::vector<uint8_t> &updated) {
+
+            return diff(original.data(), original.size(), updated.data(), updated.size());
+        }
+    };
+}
+
+#endif //BinaryDiff_H
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef ByteRange_H
+#define ByteRange_H
+
+#include <vector>
+
+#include "heckel_diff.hpp"
+
+namespace HeckelDiff {
+
+    // A run of bytes in the original and/or the update. An offset is NotFound on the side the bytes do not exist.
+    struct ByteRange final {
+
+        size_t original_offset = NotFound;
+        size_t updated_offset = NotFound;
+        size_t length = 0;
+    };
+
+    // Appends `range`, coalescing with the previous range when both sides continue where it left off.
+    inline void append_range(std::vector<ByteRange> &ranges, const ByteRange &range) {
+
+        const auto continues = [](const size_t last_offset, const size_t last_length, const size_t offset) {
+            return offset == NotFound ? last_offset == NotFound
+                                      : last_offset != NotFound && last_offset + last_length == offset;
+        };
+
+        if (!ranges.empty()) {
+
+            auto &last = ranges.back();
+
+            if (continues(last.original_offset, last.length, range.original_offset)
+                && continues(last.updated_offset, last.length, range.updated_offset)) {
+
+                last.length += range.length;
+                return;
+            }
+        }
+
+        ranges.push_back(range);
+    }
+}
+
+#endif //ByteRange_H
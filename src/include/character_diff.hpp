@@ -0,0 +1,46 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef CharacterDiff_H
+#define CharacterDiff_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "heckel_diff.hpp"
+#include "byte_range.hpp"
+
+namespace HeckelDiff {
+
+    /*
+     * Diffs UTF-8 text character by character. Each code point is decoded to an integer ID and the Heckel passes
+     * run over the IDs, so no string is allocated per character. Results are byte ranges of the two strings,
+     * keyed like Algorithm's.
+     *
+     * Bytes that are not valid UTF-8 are diffed as characters of their own, so the ranges always cover the input.
+     */
+    class CharacterAlgorithm final {
+
+        Algorithm<uint32_t> algorithm;
+
+        std::vector<uint32_t> original_ids;
+        std::vector<uint32_t> original_offsets;
+        std::vector<uint32_t> updated_ids;
+        std::vector<uint32_t> updated_offsets;
+
+    public:
+        // IDs above the Unicode range, one per byte value, stand in for invalid bytes.
+        static const uint32_t InvalidByte = 0x110000;
+
+        // Appends one ID per character and its byte offset, then a final offset of `text.size()`.
+        static void decode(const std::string &text, std::vector<uint32_t> &ids, std::vector<uint32_t> &offsets);
+
+        std::unordered_map<std::string, std::vector<ByteRange>> diff(const std::string &original,
+                                                                      const std::string &updated);
+    };
+}
+
+#endif //CharacterDiff_H
@@ -5,13 +5,17 @@
 #ifndef HeckelDiff_H
 #define HeckelDiff_H
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
-#include <stack>
 #include <limits>
 #include <memory>
-#include <functional>
+#include <iterator>
+#include <stdexcept>
+
+#include "prepared_baseline.hpp"
+#include "sketch.hpp"
 
 namespace HeckelDiff {
 
@@ -24,51 +28,210 @@ namespace HeckelDiff {
 
     struct Entry final {
 
-        std::stack<size_t> all_old_indexes;
+        // ascending, consumed from the back by pass 3
+        const uint64_t *all_old_indexes = nullptr;
+        size_t popped = 0;
 
         size_t oc = 0;
         size_t nc = 0;
+
+        size_t top() const {
+            return popped < oc ? static_cast<size_t>(all_old_indexes[oc - 1 - popped]) : NotFound;
+        }
+
+        void pop() {
+            popped += 1;
+        }
+    };
+
+    /*
+     * The working state of one side of the diff, one densely packed column per field. An item's value is not copied
+     * in, it is looked up by position in the input when pass 6 reports it.
+     *
+     * An item still points at its symbol table entry until it is matched, after which it holds the line number
+     * of its match on the other side. Both are kept, the index column doubles as the record type: Unmatched means
+     * symbol table entry, anything else a line number.
+     */
+    struct Records final {
+
+        static const uint32_t Unmatched = std::numeric_limits<uint32_t>::max();
+
+        std::vector<uint32_t> entries;
+        std::vector<uint32_t> indexes;
+
+        void resize(const size_t size) {
+            entries.resize(size);
+            indexes.assign(size, Unmatched);
+        }
+
+        void clear() {
+            entries.clear();
+            indexes.clear();
+        }
+
+        size_t size() const {
+            return entries.size();
+        }
+
+        bool empty() const {
+            return entries.empty();
+        }
+
+        void set_index(const size_t i, const size_t index) {
+            indexes[i] = static_cast<uint32_t>(index);
+        }
+
+        size_t index(const size_t i) const {
+            return indexes[i] == Unmatched ? NotFound : indexes[i];
+        }
+
+        // Records are equal when they are of the same type and share a symbol table entry.
+        bool equals(const size_t i, const Records &other, const size_t j) const {
+            return entries[i] == other.entries[j] && (indexes[i] == Unmatched) == (other.indexes[j] == Unmatched);
+        }
     };
 
+    // Where an updated item came from.
+    struct Alignment final {
+
+        size_t old_index = NotFound;  // NotFound when the item was inserted
+        bool unchanged = false;
+    };
+
+    template<typename T>
+    class Algorithm;
+
+    /*
+     * The outcome of a diff, kept as the matched records rather than as value lists. Each category is a view that
+     * classifies items as it is iterated, so categories nobody reads cost nothing.
+     *
+     * Values are read from the updated items and the baseline the diff ran against, both of which must outlive
+     * the changes. A baseline prepared on the caller's behalf is owned by the changes.
+     */
     template<typename T>
-    struct Record final {
+    class Changes final {
+
+        friend class Algorithm<T>;
 
-    private:
-        size_t m_index = NotFound;
+        Records na;
+        Records oa;
+        std::vector<Entry> entries;
+
+        const std::vector<T> *updated = nullptr;
+        const PreparedBaseline<T> *baseline = nullptr;
+        std::unique_ptr<PreparedBaseline<T>> owned_baseline;
+
+        Changes(Records &&na, Records &&oa, std::vector<Entry> &&entries, const std::vector<T> &updated,
+                const PreparedBaseline<T> &baseline);
 
     public:
-        enum Type {
-            SymbolTableEntry,
-            LineNumber
+        enum Category {
+            Inserted,
+            Moved,
+            Unchanged,
+            Deleted
+        };
+
+        class Iterator final {
+
+            const Changes<T> *changes;
+            Category category;
+            size_t i;
+            size_t end;
+
+            void skip() {
+                while (i < end && !changes->is(category, i)) {
+                    i += 1;
+                }
+            }
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T *;
+            using reference = T;
+
+            Iterator(const Changes<T> *changes, const Category category, const size_t i, const size_t end)
+                    : changes(changes), category(category), i(i), end(end) {
+                skip();
+            }
+
+            T operator*() const {
+                return changes->value(category, i);
+            }
+
+            // Position of the item, in the original for Deleted and in the update otherwise.
+            size_t index() const {
+                return i;
+            }
+
+            Iterator &operator++() {
+                i += 1;
+                skip();
+                return *this;
+            }
+
+            bool operator==(const Iterator &rhs) const {
+                return i == rhs.i;
+            }
+
+            bool operator!=(const Iterator &rhs) const {
+                return i != rhs.i;
+            }
         };
 
-        T value {};
-        Entry *entry = nullptr;
-        Type type = SymbolTableEntry;
+        class View final {
+
+            const Changes<T> *changes;
+            Category category;
+
+        public:
+            View(const Changes<T> *changes, const Category category) : changes(changes), category(category) {}
+
+            Iterator begin() const {
+                return Iterator(changes, category, 0, changes->side_size(category));
+            }
 
+            Iterator end() const {
+                return Iterator(changes, category, changes->side_size(category), changes->side_size(category));
+            }
 
-        Record<T>() {}
+            std::vector<T> to_vector() const {
+                return std::vector<T>(begin(), end());
+            }
+        };
+
+        bool is(Category category, size_t i) const;
+        T value(Category category, size_t i) const;
+
+        size_t side_size(const Category category) const {
+            return category == Deleted ? oa.size() : na.size();
+        }
 
-        Record<T>(const T value, Entry *entry) : value(value), entry(entry) {
-            type = SymbolTableEntry;
+        View inserted() const {
+            return View(this, Inserted);
         }
 
-        void set_index(const size_t index) {
-            m_index = index;
-            type = LineNumber;
+        View moved() const {
+            return View(this, Moved);
         }
 
-        auto index() const {
-            return m_index;
+        View unchanged() const {
+            return View(this, Unchanged);
         }
 
-        bool operator==(const Record<T> &rhs) const {
-            return this->type == rhs.type && this->entry == rhs.entry;
+        View deleted() const {
+            return View(this, Deleted);
         }
 
-        bool operator!=(const Record<T> &rhs) const {
-            return this->type != rhs.type || this->entry != rhs.entry;
+        // Where the updated item at `i` was matched in the original, NotFound when it was inserted.
+        size_t old_index(const size_t i) const {
+            return na.index(i);
         }
+
+        // The position of each updated item in the original, for callers that need more than the values.
+        std::vector<Alignment> alignments() const;
     };
 
     template<typename T>
@@ -79,48 +242,211 @@ namespace HeckelDiff {
             Descending = - 1
         };
 
-        std::unordered_map<T, std::unique_ptr<Entry>> symbol_table;
-        std::vector<Record<T>> oa;
-        std::vector<Record<T>> na;
+        size_t threads;
+        size_t minimum_segment_size;
 
-        static void index_item(const T &item, std::unordered_map<T, std::unique_ptr<Entry>> &symbol_table, std::function<void(Entry *&entry, const T &l_item)> &lambda);
-        static void find_unchanged_blocks(const Record<T> &record, const Direction &direction, const size_t &i, std::vector<Record<T>> &na, std::vector<Record<T>> &oa);
-        static std::vector<T> populate_deleted_items(const std::vector<Record<T>> &oa);
-        static auto populate_new_items(const std::vector<Record<T>> &na, const std::vector<Record<T>> &oa);
+        // items the original never contains, everything else was indexed by the baseline
+        std::unordered_map<T, uint32_t> symbol_table;
+        std::vector<uint32_t> direct_table;  // stands in for the symbol table when integral items are dense
+        std::vector<Entry> entries;
+        Records oa;
+        Records na;
 
-        static void pass1(const std::vector<T> &n, std::unordered_map<T, std::unique_ptr<Entry>> &symbolTable, std::vector<Record<T>> &na);
+        // how many earlier new items share each new item's entry, only kept when pass 3 runs in segments
+        std::vector<uint32_t> ranks;
 
-        static void pass2(const std::vector<T> &o, std::unordered_map<T, std::unique_ptr<Entry>>&symbolTable, std::vector<Record<T>> &oa);
+        // the baseline of recycled changes, the next diff of a plain original is prepared in its storage
+        std::unique_ptr<PreparedBaseline<T>> spare_baseline;
 
-        static void pass3(std::vector<Record<T>> &na, std::vector<Record<T>> &oa);
+        static uint32_t index_item(const T &item, const PreparedBaseline<T> &baseline, std::unordered_map<T, uint32_t> &symbol_table, std::vector<Entry> &entries);
 
-        static void pass4(std::vector<Record<T>> &na, std::vector<Record<T>> &oa);
+        // `original` is asked to claim an old record before it is read and to set its index, false stops the block.
+        template<typename Original>
+        static bool find_unchanged_blocks(const Direction &direction, const size_t &i, Records &na, Records &oa, Original &original);
+        static void extend_blocks(const Direction &direction, Records &na, Records &oa, const std::vector<size_t> &boundaries);
+        static std::vector<size_t> find_anchors(const Records &na, const Records &oa, const std::vector<Entry> &entries, size_t segments);
 
-        static void pass5(std::vector<Record<T>> &na, std::vector<Record<T>> &oa);
+        static void pass1(const std::vector<T> &n, const PreparedBaseline<T> &baseline, std::unordered_map<T, uint32_t> &symbol_table, std::vector<uint32_t> &direct_table, std::vector<Entry> &entries, std::vector<uint32_t> &ranks, Records &na);
 
-        static const std::unordered_map<std::string, std::vector<T>> pass6(std::vector<Record<T>> &na, std::vector<Record<T>> &oa);
+        static void pass2(const PreparedBaseline<T> &baseline, std::vector<Entry> &entries, Records &oa);
 
-    public:
-        auto diff(const std::vector<T> original, const std::vector<T> updated) {
+        static void pass3(Records &na, Records &oa, std::vector<Entry> &entries);
+        static void pass3(Records &na, Records &oa, const std::vector<Entry> &entries, const std::vector<uint32_t> &ranks, size_t segments);
 
-            oa.resize(original.size());
+        static void pass4(Records &na, Records &oa, const std::vector<size_t> &boundaries);
+
+        static void pass5(Records &na, Records &oa, const std::vector<size_t> &boundaries);
+
+        static const std::unordered_map<std::string, std::vector<T>> pass6(const Changes<T> &changes, size_t segments);
+
+        size_t segments_for(const size_t size) const {
+
+            const auto segments = size / minimum_segment_size;
+
+            return segments < 1 ? 1 : (segments < threads ? segments : threads);
+        }
+
+        // Pass 2 alone leaves every new item inserted and every old item deleted.
+        // Throws std::length_error when the items do not fit the 32 bit record columns.
+        void index_original(const PreparedBaseline<T> &baseline, const std::vector<T> &updated) {
+
+            if (baseline.size() + updated.size() >= Records::Unmatched) {
+                throw std::length_error("too many items to diff");
+            }
+
+            oa.resize(baseline.size());
             na.resize(updated.size());
 
-            pass1(updated, symbol_table, na);
-            pass2(original, symbol_table, oa);
-            pass3(na, oa);
-            pass4(na, oa);
-            pass5(na, oa);
+            pass2(baseline, entries, oa);
+        }
+
+        void match(const PreparedBaseline<T> &baseline, const std::vector<T> &updated) {
+
+            index_original(baseline, updated);
+
+            const auto segments = segments_for(updated.size());
+
+            ranks.resize(segments > 1 ? updated.size() : 0);
 
-            auto result = pass6(na, oa);
+            pass1(updated, baseline, symbol_table, direct_table, entries, ranks, na);
+
+            if (segments > 1) {
+                pass3(na, oa, entries, ranks, segments);
+            } else {
+                pass3(na, oa, entries);
+            }
+
+            const auto boundaries = find_anchors(na, oa, entries, segments);
+
+            pass4(na, oa, boundaries);
+            pass5(na, oa, boundaries);
+        }
+
+        // The records move out of the Algorithm into the changes.
+        Changes<T> take_changes(const PreparedBaseline<T> &baseline, const std::vector<T> &updated) {
+
+            Changes<T> result(std::move(na), std::move(oa), std::move(entries), updated, baseline);
+
+            reset();
+
+            return result;
+        }
+
+        void reset() {
 
             symbol_table.clear();
+            direct_table.clear();
+            entries.clear();
             oa.clear();
             na.clear();
+            ranks.clear();
+        }
+
+    public:
+        /*
+         * Passes 3-6 split inputs of at least twice `minimum_segment_size` items into segments run on up to
+         * `threads` threads, or one thread when `threads` is 0. The results do not depend on the thread count.
+         */
+        explicit Algorithm(const size_t threads = 1, const size_t minimum_segment_size = 1 << 16)
+                : threads(threads < 1 ? 1 : threads),
+                  minimum_segment_size(minimum_segment_size < 1 ? 1 : minimum_segment_size) {}
+
+        auto diff(const std::vector<T> original, const std::vector<T> updated) {
+
+            return pass6(changes(original, updated), segments_for(updated.size()));
+        }
+
+        // Only the updated items are indexed, the original was indexed when `baseline` was prepared.
+        auto diff(const PreparedBaseline<T> &baseline, const std::vector<T> &updated) {
+
+            return pass6(changes(baseline, updated), segments_for(updated.size()));
+        }
+
+        // Passes 1-5 only, the records move out of the Algorithm into the changes. `updated` must outlive them.
+        Changes<T> changes(const std::vector<T> &original, const std::vector<T> &updated) {
+
+            std::unique_ptr<PreparedBaseline<T>> baseline;
+
+            if (spare_baseline) {
+
+                baseline = std::move(spare_baseline);
+                *baseline = PreparedBaseline<T>::prepare(original, std::move(*baseline));
+
+            } else {
+
+                baseline = std::make_unique<PreparedBaseline<T>>(PreparedBaseline<T>::prepare(original));
+            }
+
+            auto result = changes(*baseline, updated);
+            result.owned_baseline = std::move(baseline);
 
             return result;
         }
+
+        // As above, `baseline` must outlive the changes too.
+        Changes<T> changes(const PreparedBaseline<T> &baseline, const std::vector<T> &updated) {
+
+            match(baseline, updated);
+
+            return take_changes(baseline, updated);
+        }
+
+        /*
+         * Bails out before passes 1 and 3-5 when the sketches estimate the two sides' items to be less than
+         * `threshold` similar, reporting every original item deleted and every updated item inserted. The sketches
+         * can be kept and reused across diffs.
+         */
+        Changes<T> changes(const PreparedBaseline<T> &baseline, const std::vector<T> &updated,
+                           const Sketch<T> &baseline_sketch, const Sketch<T> &updated_sketch, const double threshold) {
+
+            if (baseline_sketch.similarity(updated_sketch) >= threshold) {
+                return changes(baseline, updated);
+            }
+
+            index_original(baseline, updated);
+
+            return take_changes(baseline, updated);
+        }
+
+        auto diff(const PreparedBaseline<T> &baseline, const std::vector<T> &updated,
+                  const Sketch<T> &baseline_sketch, const Sketch<T> &updated_sketch, const double threshold) {
+
+            return pass6(changes(baseline, updated, baseline_sketch, updated_sketch, threshold),
+                         segments_for(updated.size()));
+        }
+
+        auto diff(const std::vector<T> original, const std::vector<T> updated, const double threshold) {
+
+            const auto baseline = PreparedBaseline<T>::prepare(original);
+
+            return diff(baseline, updated, Sketch<T>::of(baseline), Sketch<T>::of(updated), threshold);
+        }
+
+        // Takes back the records of changes nobody reads any more, and the baseline prepared for them if any, so
+        // the next diff reuses their storage.
+        void recycle(Changes<T> &&changes) {
+
+            na = std::move(changes.na);
+            oa = std::move(changes.oa);
+            entries = std::move(changes.entries);
+
+            if (changes.owned_baseline) {
+                spare_baseline = std::move(changes.owned_baseline);
+            }
+
+            reset();
+        }
+
+        std::vector<Alignment> align(const std::vector<T> &original, const std::vector<T> &updated) {
+
+            return changes(original, updated).alignments();
+        }
+
+        std::vector<Alignment> align(const PreparedBaseline<T> &baseline, const std::vector<T> &updated) {
+
+            return changes(baseline, updated).alignments();
+        }
     };
 }
 
-#endif //${name}
+#endif //HeckelDiff_H
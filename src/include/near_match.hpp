@@ -0,0 +1,63 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef NearMatch_H
+#define NearMatch_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "heckel_diff.hpp"
+
+namespace HeckelDiff {
+
+    struct NearMatchOptions final {
+
+        size_t shingle_size = 3;  // bytes
+        double threshold = 0.75;  // least fraction of fingerprint bits a pair must share
+
+        // Items are only compared when their fingerprints agree on every sampled bit of one of the tables. More
+        // tables find more pairs, more bits per table compare fewer items.
+        size_t tables = 16;
+        size_t sampled_bits = 12;
+
+        // A table entry shared by more deleted items than this only offers the first of them, bounding the work.
+        size_t bucket_size = 64;
+    };
+
+    // A deleted item paired with an inserted one it resembles: moved and modified.
+    struct MovedModified final {
+
+        size_t old_index = NotFound;
+        size_t new_index = NotFound;
+        double similarity = 0.0;
+    };
+
+    /*
+     * Pairs up the items a diff left deleted and inserted that are nearly the same. Each item gets a 64 bit SimHash
+     * fingerprint of its shingles, overlapping runs of bytes, so similar items differ in few bits. Each table samples
+     * a fixed set of bits and only items the bits agree on are compared, keeping the work near linear.
+     *
+     * Inserted items are paired in order, each with the most similar deleted item left that meets the threshold.
+     */
+    class NearMatcher final {
+
+        NearMatchOptions options;
+
+    public:
+        // Throws std::invalid_argument if the options are out of range.
+        explicit NearMatcher(const NearMatchOptions &options = NearMatchOptions());
+
+        static uint64_t fingerprint(const std::string &item, size_t shingle_size);
+
+        // Fraction of bits two fingerprints share, in [0, 1].
+        static double similarity(uint64_t a, uint64_t b);
+
+        // Ordered by new index.
+        std::vector<MovedModified> match(const Changes<std::string> &changes) const;
+    };
+}
+
+#endif //NearMatch_H
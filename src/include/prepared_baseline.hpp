@@ -0,0 +1,108 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef PreparedBaseline_H
+#define PreparedBaseline_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <limits>
+
+namespace HeckelDiff {
+
+    class MappedFile;
+
+    /*
+     * The indexed form of an original sequence: its symbol table, occurrence counts and old index lists.
+     *
+     * The image is a flat array of 64 bit words that only refers to itself through indexes, so it can be
+     * written to disk once and mapped back in by any process. Words are stored in native byte order.
+     *
+     *  header      | magic, version, value kind, value width, item count, symbol count, slot count, blob bytes,
+     *              | direct minimum, direct slot count
+     *  symbols     | hash, oc, offset of the symbol's first old index
+     *  slots       | open addressed hash table of symbol id + 1 (0 is an empty slot)
+     *  old indexes | every old index, grouped by symbol and ascending within a group
+     *  positions   | symbol id of each item in the original
+     *  values      | one value per symbol (strings: symbol count + 1 blob offsets followed by the blob)
+     *  direct      | dense integral originals: 32 bit symbol id + 1 per value from the minimum, two to a word
+     */
+    template<typename T>
+    class PreparedBaseline final {
+
+        // the working vectors of `prepare`, only kept by baselines prepared from a recycled one
+        struct Scratch;
+
+        std::vector<uint64_t> m_storage;
+        std::unique_ptr<MappedFile> m_mapping;
+        std::unique_ptr<Scratch> m_scratch;
+
+        const uint64_t *m_words = nullptr;
+        size_t m_word_count = 0;
+
+        const uint64_t *m_symbols = nullptr;
+        const uint64_t *m_slots = nullptr;
+        const uint64_t *m_old_indexes = nullptr;
+        const uint64_t *m_positions = nullptr;
+        const uint64_t *m_values = nullptr;
+        const uint32_t *m_direct = nullptr;
+
+        PreparedBaseline();
+
+        // Places the sections and checks they fit `word_count`. `check_body` checks what the sections hold.
+        void bind(const uint64_t *words, size_t word_count);
+        void check_body() const;
+        bool value_equals(size_t symbol, const T &item) const;
+
+    public:
+        static const size_t NoSymbol = std::numeric_limits<size_t>::max();
+
+        PreparedBaseline(PreparedBaseline &&other) noexcept;
+        PreparedBaseline &operator=(PreparedBaseline &&other) noexcept;
+        PreparedBaseline(const PreparedBaseline &) = delete;
+        PreparedBaseline &operator=(const PreparedBaseline &) = delete;
+        ~PreparedBaseline();
+
+        // Pass 2: Put old text into entry table, once.
+        static PreparedBaseline prepare(const std::vector<T> &original);
+
+        // As above, building the image in the storage of `recycled`, an earlier prepared baseline, so repeated
+        // prepares of similar sizes stop allocating. The result keeps that storage for the next.
+        static PreparedBaseline prepare(const std::vector<T> &original, PreparedBaseline &&recycled);
+
+        /*
+         * Maps a file written by `write`. The header and the section sizes are checked in constant time, so mapping
+         * stays cheap however large the file. What the sections hold is trusted unless `verify` is set, which reads
+         * the whole file to check every index in it.
+         *
+         * Throws std::runtime_error if the file is missing or malformed.
+         */
+        static PreparedBaseline map(const std::string &path, bool verify = false);
+
+        // Throws std::runtime_error if the file cannot be written.
+        void write(const std::string &path) const;
+
+        size_t size() const;
+        size_t symbol_count() const;
+
+        // Symbol id of `item`, or NoSymbol when the original never contains it.
+        size_t find(const T &item) const;
+
+        // The stable hash the baseline files symbols under.
+        static uint64_t hash(const T &item);
+        uint64_t symbol_hash(size_t symbol) const;
+
+        size_t symbol_at(size_t old_index) const;
+        size_t occurrences(size_t symbol) const;
+
+        // Ascending old indexes of `symbol`, `occurrences(symbol)` of them.
+        const uint64_t *old_indexes(size_t symbol) const;
+
+        T value(size_t old_index) const;
+    };
+}
+
+#endif //PreparedBaseline_H
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef Sketch_H
+#define Sketch_H
+
+#include <cstdint>
+#include <vector>
+
+#include "prepared_baseline.hpp"
+
+namespace HeckelDiff {
+
+    /*
+     * Bottom-k sketch of the distinct items of a sequence: the k smallest of their stable hashes. Two sketches
+     * estimate the Jaccard similarity of their sequences' item sets, exactly while the sets hold fewer than k items.
+     *
+     * Sketches only depend on their own sequence, so one sketch of a baseline serves every diff against it.
+     */
+    template<typename T>
+    class Sketch final {
+
+        std::vector<uint64_t> m_hashes;  // ascending
+        size_t m_size = 0;
+
+        Sketch(std::vector<uint64_t> &&hashes, size_t size);
+
+    public:
+        static const size_t DefaultSize = 128;
+
+        static Sketch of(const std::vector<T> &items, size_t size = DefaultSize);
+
+        // Reads the hashes the baseline already holds, rather than hashing the original again.
+        static Sketch of(const PreparedBaseline<T> &baseline, size_t size = DefaultSize);
+
+        // Estimated Jaccard similarity in [0, 1]. Two empty sequences are identical.
+        double similarity(const Sketch &other) const;
+    };
+}
+
+#endif //Sketch_H
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef SortedDiff_H
+#define SortedDiff_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "heckel_diff.hpp"
+
+namespace HeckelDiff {
+
+    /*
+     * Diffs inputs that are already sorted by `Compare` with a single merge pass, in place of the symbol table.
+     * Items that neither compare before the other are the same item, so a comparator that only looks at a key
+     * matches items by key.
+     *
+     * Matched items keep their relative order on both sides, so the only moves are shifts: a match at the same
+     * position is unchanged, anywhere else it has moved. Without duplicates that is how Algorithm classifies them
+     * too. Duplicates are paired in order here, where Algorithm may pair them differently, so the two can disagree.
+     *
+     * Each input is read once, front to back, and nothing is retained, so input iterators such as database
+     * cursors can be diffed without loading either side.
+     */
+    template<typename T, typename Compare = std::less<T>>
+    class SortedAlgorithm final {
+
+        Compare less;
+
+    public:
+        using Category = typename Changes<T>::Category;
+
+        explicit SortedAlgorithm(Compare less = Compare()) : less(less) {}
+
+        // Calls `visit(category, item, old_index, new_index)` for each item, with NotFound for the missing side.
+        template<typename OriginalIterator, typename UpdatedIterator, typename Visitor>
+        void diff(OriginalIterator original, const OriginalIterator original_end,
+                  UpdatedIterator updated, const UpdatedIterator updated_end,
+                  Visitor &&visit) const {
+
+            size_t old_index = 0;
+            size_t new_index = 0;
+
+            while (original != original_end && updated != updated_end) {
+
+                const T &o = *original;
+                const T &n = *updated;
+
+                if (less(o, n)) {
+
+                    visit(Changes<T>::Deleted, o, old_index, NotFound);
+
+                    ++original;
+                    old_index += 1;
+
+                } else if (less(n, o)) {
+
+                    visit(Changes<T>::Inserted, n, NotFound, new_index);
+
+                    ++updated;
+                    new_index += 1;
+
+                } else {
+
+                    visit(old_index == new_index ? Changes<T>::Unchanged : Changes<T>::Moved, n, old_index, new_index);
+
+                    ++original;
+                    ++updated;
+                    old_index += 1;
+                    new_index += 1;
+                }
+            }
+
+            for (; original != original_end; ++original) {
+
+                visit(Changes<T>::Deleted, *original, old_index, NotFound);
+                old_index += 1;
+            }
+
+            for (; updated != updated_end; ++updated) {
+
+                visit(Changes<T>::Inserted, *updated, NotFound, new_index);
+                new_index += 1;
+            }
+        }
+
+        std::unordered_map<std::string, std::vector<T>> diff(const std::vector<T> &original,
+                                                             const std::vector<T> &updated) const {
+
+            std::vector<T> inserted, deleted, moved, unchanged;
+
+            diff(original.begin(), original.end(), updated.begin(), updated.end(),
+                 [&](const Category category, const T &item, const size_t, const size_t) {
+
+                     switch (category) {
+                         case Changes<T>::Inserted:
+                             inserted.push_back(item);
+                             break;
+                         case Changes<T>::Deleted:
+                             deleted.push_back(item);
+                             break;
+                         case Changes<T>::Moved:
+                             moved.push_back(item);
+                             break;
+                         case Changes<T>::Unchanged:
+                             unchanged.push_back(item);
+                             break;
+                     }
+                 });
+
+            const std::unordered_map<std::string, std::vector<T>> results {
+                    {INSERTED,  inserted},
+                    {MOVED,     moved},
+                    {UNCHANGED, unchanged},
+                    {DELETED,   deleted}
+            };
+
+            return results;
+        }
+    };
+}
+
+#endif //SortedDiff_H
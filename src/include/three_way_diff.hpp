@@ -0,0 +1,68 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#ifndef ThreeWayDiff_H
+#define ThreeWayDiff_H
+
+#include <vector>
+
+#include "heckel_diff.hpp"
+
+namespace HeckelDiff {
+
+    /*
+     * Merges two updates of a common base. The base is indexed once and both sides are matched against it, each by
+     * its own Algorithm, in parallel.
+     *
+     * Items matched in base, ours and theirs, in the same order on all three, are stable. Between stable runs a
+     * region is taken from whichever side changed it, and is a conflict when both changed it differently. Moves
+     * therefore merge as a deletion and an insertion.
+     */
+    template<typename T>
+    class ThreeWayAlgorithm final {
+
+        Algorithm<T> ours_algorithm;
+        Algorithm<T> theirs_algorithm;
+        bool parallel;
+
+    public:
+        // Half-open ranges of the base, ours and theirs that make up one region of the merge.
+        struct Region final {
+
+            enum Kind {
+                Unchanged,
+                Ours,       // only ours changed, take ours
+                Theirs,     // only theirs changed, take theirs
+                Both,       // both changed alike, take either
+                Conflict
+            };
+
+            Kind kind = Unchanged;
+
+            size_t base_begin = 0;
+            size_t base_end = 0;
+            size_t ours_begin = 0;
+            size_t ours_end = 0;
+            size_t theirs_begin = 0;
+            size_t theirs_end = 0;
+        };
+
+        explicit ThreeWayAlgorithm(bool parallel = true) : parallel(parallel) {}
+
+        std::vector<Region> merge(const PreparedBaseline<T> &base, const std::vector<T> &ours,
+                                  const std::vector<T> &theirs);
+
+        std::vector<Region> merge(const std::vector<T> &base, const std::vector<T> &ours,
+                                  const std::vector<T> &theirs) {
+
+            return merge(PreparedBaseline<T>::prepare(base), ours, theirs);
+        }
+
+        // The merged items, or false and nothing when a region conflicts.
+        static bool resolve(const std::vector<Region> &regions, const std::vector<T> &ours,
+                            const std::vector<T> &theirs, std::vector<T> &merged);
+    };
+}
+
+#endif //ThreeWayDiff_H
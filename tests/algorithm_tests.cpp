@@ -2,7 +2,10 @@
  * Copyright 2017 Rowun Giles - http://github.com/rowungiles
  */
 
+#include <algorithm>
 #include <chrono>
+#include <iomanip>
+#include <random>
 #include "gtest/gtest.h"
 #include "heckel_diff.hpp"
 #include "helpers.hpp"
@@ -373,3 +376,154 @@ TEST(HeckelDiff, IGListKitWhenDeletingObjectsWithArrayOfEqualObjectsThatChangeCo
 
     delete expected;
 }
+
+TEST(HeckelDiff, AlignReportsOldIndexes) {
+
+    std::vector<size_t> original {1, 2, 3, 4, 5};
+    std::vector<size_t> updated {3, 2, 1, 4, 6};
+
+    HeckelDiff::Algorithm<size_t> h;
+
+    auto alignments = h.align(original, updated);
+
+    ASSERT_EQ(updated.size(), alignments.size());
+
+    EXPECT_EQ(2u, alignments[0].old_index);
+    EXPECT_EQ(1u, alignments[1].old_index);
+    EXPECT_EQ(0u, alignments[2].old_index);
+    EXPECT_EQ(3u, alignments[3].old_index);
+    EXPECT_EQ(HeckelDiff::NotFound, alignments[4].old_index);
+
+    EXPECT_FALSE(alignments[0].unchanged);
+    EXPECT_TRUE(alignments[1].unchanged);
+    EXPECT_TRUE(alignments[3].unchanged);
+}
+
+TEST(HeckelDiff, ChangesViewsMatchDiff) {
+
+    std::vector<std::string> original {"A", "X", "C", "Y", "D", "W", "E", "A", "E"};
+    std::vector<std::string> updated {"A", "B", "C", "D", "E", "A", "Y", "Y"};
+
+    HeckelDiff::Algorithm<std::string> h;
+
+    auto expected = h.diff(original, updated);
+    auto changes = h.changes(original, updated);
+
+    EXPECT_EQ(expected[HeckelDiff::INSERTED], changes.inserted().to_vector());
+    EXPECT_EQ(expected[HeckelDiff::DELETED], changes.deleted().to_vector());
+    EXPECT_EQ(expected[HeckelDiff::MOVED], changes.moved().to_vector());
+    EXPECT_EQ(expected[HeckelDiff::UNCHANGED], changes.unchanged().to_vector());
+}
+
+TEST(HeckelDiff, ChangesViewsReportPositions) {
+
+    std::vector<size_t> original {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<size_t> updated  {0, 2, 3, 4, 7, 6, 9, 5, 10};
+
+    HeckelDiff::Algorithm<size_t> h;
+
+    auto changes = h.changes(original, updated);
+
+    std::vector<size_t> inserted_at, deleted_at;
+
+    for (auto it = changes.inserted().begin(); it != changes.inserted().end(); ++it) {
+        inserted_at.push_back(it.index());
+    }
+
+    for (auto it = changes.deleted().begin(); it != changes.deleted().end(); ++it) {
+        deleted_at.push_back(it.index());
+    }
+
+    EXPECT_EQ(std::vector<size_t>({6, 8}), inserted_at);
+    EXPECT_EQ(std::vector<size_t>({1, 8}), deleted_at);
+
+    // the Algorithm gave up its records, it is free to run another diff
+    auto next = h.diff(updated, original);
+
+    EXPECT_EQ(std::vector<size_t>({9, 10}), next[HeckelDiff::DELETED]);
+    EXPECT_EQ(std::vector<size_t>({9, 10}), changes.inserted().to_vector());
+}
+
+TEST(HeckelDiff, ParallelMatchesSerial) {
+
+    std::mt19937 random(3);
+
+    for (size_t alphabet : {50, 500, 5000}) {
+
+        std::vector<size_t> original(4000);
+
+        for (auto &item : original) {
+            item = random() % alphabet;
+        }
+
+        // an edited copy: dropped, duplicated and inserted items, and a block moved
+        std::vector<size_t> updated;
+
+        for (const auto item : original) {
+
+            switch (random() % 10) {
+                case 0:
+                    continue;
+                case 1:
+                    updated.push_back(random() % alphabet);
+                    break;
+                case 2:
+                    updated.push_back(original[random() % original.size()]);
+                    break;
+                default:
+                    break;
+            }
+
+            updated.push_back(item);
+        }
+
+        std::rotate(updated.begin() + 1000, updated.begin() + 1500, updated.begin() + 2500);
+
+        HeckelDiff::Algorithm<size_t> serial;
+        HeckelDiff::Algorithm<size_t> parallel(4, 64);
+
+        EXPECT_EQ(serial.diff(original, updated), parallel.diff(original, updated));
+
+        const auto serial_alignments = serial.align(original, updated);
+        const auto parallel_alignments = parallel.align(original, updated);
+
+        ASSERT_EQ(serial_alignments.size(), parallel_alignments.size());
+
+        for (size_t i = 0; i < serial_alignments.size(); i += 1) {
+
+            EXPECT_EQ(serial_alignments[i].old_index, parallel_alignments[i].old_index);
+            EXPECT_EQ(serial_alignments[i].unchanged, parallel_alignments[i].unchanged);
+        }
+    }
+}
+
+TEST(HeckelDiff, ZeroThreadsRunsSerially) {
+
+    // std::thread::hardware_concurrency() may report 0
+    HeckelDiff::Algorithm<size_t> serial;
+    HeckelDiff::Algorithm<size_t> unknown(0, 1);
+
+    std::vector<size_t> original {1, 2, 3};
+    std::vector<size_t> updated {3, 2, 1, 4};
+
+    EXPECT_EQ(serial.diff(original, updated), unknown.diff(original, updated));
+}
+
+TEST(HeckelDiff, RecycledChangesLeaveLaterDiffsAlone) {
+
+    std::vector<std::string> original {"A", "X", "C", "Y", "D", "W", "E", "A", "E"};
+    std::vector<std::string> updated {"A", "B", "C", "D", "E", "A", "Y", "Y"};
+    std::vector<std::string> shorter {"B", "A", "C"};
+
+    HeckelDiff::Algorithm<std::string> h;
+    HeckelDiff::Algorithm<std::string> recycling;
+
+    recycling.recycle(recycling.changes(original, updated));
+
+    // the storage of the longer diff is reused, none of its records are
+    const auto changes = recycling.changes(updated, shorter);
+
+    EXPECT_EQ(h.diff(updated, shorter)[HeckelDiff::DELETED], changes.deleted().to_vector());
+    EXPECT_EQ(h.diff(updated, shorter)[HeckelDiff::MOVED], changes.moved().to_vector());
+    EXPECT_EQ(h.diff(original, updated), recycling.diff(original, updated));
+}
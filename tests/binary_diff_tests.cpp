@@ -0,0 +1,178 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include "gtest/gtest.h"
+#include "binary_diff.hpp"
+
+static std::vector<uint8_t> random_blob(const size_t size, const uint32_t seed) {
+
+    std::mt19937 generator(seed);
+    std::vector<uint8_t> blob(size);
+
+    for (auto &byte : blob) {
+        byte = static_cast<uint8_t>(generator());
+    }
+
+    return blob;
+}
+
+// Rebuild the update from the ranges, the way a receiver holding the original would.
+static std::vector<uint8_t> apply(const std::vector<uint8_t> &original, const std::vector<uint8_t> &updated,
+                                  std::unordered_map<std::string, std::vector<HeckelDiff::ByteRange>> &result) {
+
+    std::vector<uint8_t> rebuilt(updated.size(), 0);
+
+    for (const auto &range : result[HeckelDiff::LITERAL]) {
+        std::copy_n(updated.begin() + range.updated_offset, range.length, rebuilt.begin() + range.updated_offset);
+    }
+
+    for (const auto &key : {HeckelDiff::COPIED, HeckelDiff::MOVED}) {
+        for (const auto &range : result[key]) {
+            std::copy_n(original.begin() + range.original_offset, range.length,
+                        rebuilt.begin() + range.updated_offset);
+        }
+    }
+
+    return rebuilt;
+}
+
+static size_t total_length(const std::vector<HeckelDiff::ByteRange> &ranges) {
+
+    size_t length = 0;
+
+    for (const auto &range : ranges) {
+        length += range.length;
+    }
+
+    return length;
+}
+
+TEST(BinaryDiff, ChunksCoverInputWithinBounds) {
+
+    HeckelDiff::ChunkingOptions options;
+    const auto blob = random_blob(1 << 20, 1);
+
+    const auto chunks = HeckelDiff::BinaryAlgorithm::chunks(blob.data(), blob.size(), options);
+
+    size_t offset = 0;
+
+    for (size_t i = 0; i < chunks.size(); i += 1) {
+
+        EXPECT_EQ(offset, chunks[i].offset);
+        EXPECT_LE(chunks[i].length, options.max_size);
+
+        if (i + 1 < chunks.size()) {
+            EXPECT_GE(chunks[i].length, options.min_size);
+        }
+
+        offset += chunks[i].length;
+    }
+
+    EXPECT_EQ(blob.size(), offset);
+}
+
+TEST(BinaryDiff, IdenticalBlobsAreOneCopiedRange) {
+
+    const auto blob = random_blob(256 * 1024, 2);
+
+    HeckelDiff::BinaryAlgorithm h;
+
+    auto result = h.diff(blob, blob);
+
+    ASSERT_EQ(1u, result[HeckelDiff::COPIED].size());
+    EXPECT_EQ(0u, result[HeckelDiff::COPIED][0].original_offset);
+    EXPECT_EQ(blob.size(), result[HeckelDiff::COPIED][0].length);
+    EXPECT_TRUE(result[HeckelDiff::LITERAL].empty());
+}
+
+TEST(BinaryDiff, InsertionOnlySendsNearbyChunks) {
+
+    HeckelDiff::ChunkingOptions options;
+    const auto original = random_blob(1 << 20, 3);
+    const auto inserted = random_blob(100, 4);
+
+    auto updated = original;
+    updated.insert(updated.begin() + 300 * 1024, inserted.begin(), inserted.end());
+
+    HeckelDiff::BinaryAlgorithm h(options);
+
+    auto result = h.diff(original, updated);
+
+    EXPECT_EQ(updated, apply(original, updated, result));
+    EXPECT_LE(total_length(result[HeckelDiff::LITERAL]), 2 * options.max_size + inserted.size());
+    EXPECT_EQ(updated.size(), total_length(result[HeckelDiff::COPIED]) + total_length(result[HeckelDiff::MOVED])
+                              + total_length(result[HeckelDiff::LITERAL]));
+}
+
+TEST(BinaryDiff, SwappedHalvesAreMoved) {
+
+    const auto first = random_blob(200 * 1024, 5);
+    const auto second = random_blob(200 * 1024, 6);
+
+    std::vector<uint8_t> original(first);
+    original.insert(original.end(), second.begin(), second.end());
+
+    std::vector<uint8_t> updated(second);
+    updated.insert(updated.end(), first.begin(), first.end());
+
+    HeckelDiff::BinaryAlgorithm h;
+
+    auto result = h.diff(original, updated);
+
+    EXPECT_EQ(updated, apply(original, updated, result));
+    EXPECT_FALSE(result[HeckelDiff::MOVED].empty());
+}
+
+TEST(BinaryDiff, RejectsInconsistentChunkSizes) {
+
+    HeckelDiff::ChunkingOptions options;
+    options.average_size = 3000;
+
+    EXPECT_THROW(HeckelDiff::BinaryAlgorithm h(options), std::invalid_argument);
+}
+
+TEST(BinaryDiff, ChunksRejectsInconsistentChunkSizes) {
+
+    std::vector<uint8_t> blob(100, 7);
+
+    HeckelDiff::ChunkingOptions empty;
+    empty.min_size = 0;
+    empty.max_size = 0;
+
+    HeckelDiff::ChunkingOptions no_average;
+    no_average.average_size = 0;
+
+    EXPECT_THROW(HeckelDiff::BinaryAlgorithm::chunks(blob.data(), blob.size(), empty), std::invalid_argument);
+    EXPECT_THROW(HeckelDiff::BinaryAlgorithm::chunks(blob.data(), blob.size(), no_average), std::invalid_argument);
+}
+
+TEST(BinaryDiff, RepeatedChunksAreNotLiteral) {
+
+    HeckelDiff::ChunkingOptions options;
+    HeckelDiff::BinaryAlgorithm h(options);
+
+    const auto original = random_blob(1 << 20, 11);
+    const auto cuts = HeckelDiff::BinaryAlgorithm::chunks(original.data(), original.size(), options);
+
+    ASSERT_GT(cuts.size(), 30u);
+
+    // a run of the original's own chunks copied in again at one of its chunk boundaries
+    const auto from = cuts[5].offset;
+    const auto to = cuts[25].offset;
+    const auto at = cuts[15].offset;
+
+    std::vector<uint8_t> updated(original.begin(), original.begin() + at);
+
+    updated.insert(updated.end(), original.begin() + from, original.begin() + to);
+    updated.insert(updated.end(), original.begin() + at, original.end());
+
+    auto result = h.diff(original, updated);
+
+    EXPECT_EQ(0u, total_length(result[HeckelDiff::LITERAL]));
+    EXPECT_EQ(updated, apply(original, updated, result));
+    EXPECT_GE(total_length(result[HeckelDiff::MOVED]), to - from);
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include "gtest/gtest.h"
+#include "character_diff.hpp"
+
+static std::string bytes_of(const std::string &text, const std::vector<HeckelDiff::ByteRange> &ranges,
+                            const bool original) {
+
+    std::string result;
+
+    for (const auto &range : ranges) {
+        result += text.substr(original ? range.original_offset : range.updated_offset, range.length);
+    }
+
+    return result;
+}
+
+TEST(CharacterDiff, DecodesCodePointsAndOffsets) {
+
+    std::vector<uint32_t> ids, offsets;
+
+    HeckelDiff::CharacterAlgorithm::decode("plain ascii text, caf\xc3\xa9 \xe2\x82\xac\xf0\x9f\x98\x80", ids, offsets);
+
+    ASSERT_EQ(25u, ids.size());
+    ASSERT_EQ(26u, offsets.size());
+
+    EXPECT_EQ(static_cast<uint32_t>('p'), ids[0]);
+    EXPECT_EQ(0xe9u, ids[21]);
+    EXPECT_EQ(0x20acu, ids[23]);
+    EXPECT_EQ(0x1f600u, ids[24]);
+
+    EXPECT_EQ(21u, offsets[21]);
+    EXPECT_EQ(24u, offsets[23]);
+    EXPECT_EQ(27u, offsets[24]);
+    EXPECT_EQ(31u, offsets[25]);
+}
+
+TEST(CharacterDiff, InvalidBytesAreCharactersOfTheirOwn) {
+
+    std::vector<uint32_t> ids, offsets;
+
+    // a stray continuation byte, a surrogate and a truncated sequence
+    HeckelDiff::CharacterAlgorithm::decode("a\x80" "b\xed\xa0\x80" "c\xe2\x82", ids, offsets);
+
+    const std::vector<uint32_t> expected {'a', HeckelDiff::CharacterAlgorithm::InvalidByte + 0x80, 'b',
+                                          HeckelDiff::CharacterAlgorithm::InvalidByte + 0xed,
+                                          HeckelDiff::CharacterAlgorithm::InvalidByte + 0xa0,
+                                          HeckelDiff::CharacterAlgorithm::InvalidByte + 0x80, 'c',
+                                          HeckelDiff::CharacterAlgorithm::InvalidByte + 0xe2,
+                                          HeckelDiff::CharacterAlgorithm::InvalidByte + 0x82};
+
+    EXPECT_EQ(expected, ids);
+    EXPECT_EQ(ids.size() + 1, offsets.size());
+}
+
+TEST(CharacterDiff, ReportsByteRanges) {
+
+    const std::string original = "na\xc3\xafve caf\xc3\xa9";
+    const std::string updated = "naive caf\xc3\xa9!";
+
+    HeckelDiff::CharacterAlgorithm h;
+
+    auto actual = h.diff(original, updated);
+
+    EXPECT_EQ("\xc3\xaf", bytes_of(original, actual[HeckelDiff::DELETED], true));
+    EXPECT_EQ("i!", bytes_of(updated, actual[HeckelDiff::INSERTED], false));
+
+    for (const auto &key : {HeckelDiff::MOVED, HeckelDiff::UNCHANGED}) {
+        EXPECT_EQ(bytes_of(original, actual[key], true), bytes_of(updated, actual[key], false));
+    }
+}
+
+TEST(CharacterDiff, IdenticalTextIsOneUnchangedRange) {
+
+    const std::string text = "\xe2\x80\x9cQuoted\xe2\x80\x9d, with \xc3\xbcmlauts and \xf0\x9f\x98\x80";
+
+    HeckelDiff::CharacterAlgorithm h;
+
+    auto actual = h.diff(text, text);
+
+    ASSERT_EQ(1u, actual[HeckelDiff::UNCHANGED].size());
+    EXPECT_EQ(0u, actual[HeckelDiff::UNCHANGED][0].original_offset);
+    EXPECT_EQ(text.size(), actual[HeckelDiff::UNCHANGED][0].length);
+    EXPECT_TRUE(actual[HeckelDiff::INSERTED].empty());
+    EXPECT_TRUE(actual[HeckelDiff::DELETED].empty());
+}
+
+TEST(CharacterDiff, ReusedAlgorithmMatchesFreshOnes) {
+
+    // ASCII is indexed by value, a few far apart code points are hashed, the reused baseline switches between them
+    const std::vector<std::pair<std::string, std::string>> pairs {
+            {"a mass of long words", "a mass of latin words falls"},
+            {"\xf0\x9f\x98\x80 ok \xf0\x9f\x98\x81", "ok \xf0\x9f\x98\x80"},
+            {"snow", "soft snow"}
+    };
+
+    HeckelDiff::CharacterAlgorithm reused;
+
+    for (const auto &pair : pairs) {
+
+        HeckelDiff::CharacterAlgorithm fresh;
+
+        auto expected = fresh.diff(pair.first, pair.second);
+        auto actual = reused.diff(pair.first, pair.second);
+
+        for (const auto &key : {HeckelDiff::INSERTED, HeckelDiff::DELETED, HeckelDiff::MOVED, HeckelDiff::UNCHANGED}) {
+
+            ASSERT_EQ(expected[key].size(), actual[key].size()) << key;
+
+            for (size_t i = 0; i < actual[key].size(); i += 1) {
+
+                EXPECT_EQ(expected[key][i].original_offset, actual[key][i].original_offset) << key;
+                EXPECT_EQ(expected[key][i].updated_offset, actual[key][i].updated_offset) << key;
+                EXPECT_EQ(expected[key][i].length, actual[key][i].length) << key;
+            }
+        }
+    }
+}
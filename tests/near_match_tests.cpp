@@ -0,0 +1,95 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include <stdexcept>
+#include "gtest/gtest.h"
+#include "near_match.hpp"
+
+TEST(NearMatch, PairsMovedAndModifiedLines) {
+
+    std::vector<std::string> original {
+            "[server]",
+            "    host = example.org",
+            "    port = 8080",
+            "[logging]",
+            "    level = info",
+            "    file = /var/log/app.log"
+    };
+
+    std::vector<std::string> updated {
+            "[logging]",
+            "    level = info",
+            "    file = /var/log/apps.log",
+            "[server]",
+            "    host = example.com",
+            "    port = 8080",
+            "    workers = 16"
+    };
+
+    HeckelDiff::Algorithm<std::string> h;
+    const auto changes = h.changes(original, updated);
+
+    const auto pairs = HeckelDiff::NearMatcher().match(changes);
+
+    ASSERT_EQ(2u, pairs.size());
+
+    EXPECT_EQ(5u, pairs[0].old_index);
+    EXPECT_EQ(2u, pairs[0].new_index);
+    EXPECT_EQ(1u, pairs[1].old_index);
+    EXPECT_EQ(4u, pairs[1].new_index);
+
+    for (const auto &pair : pairs) {
+        EXPECT_GE(pair.similarity, 0.75);
+    }
+}
+
+TEST(NearMatch, LeavesDissimilarLinesAlone) {
+
+    std::vector<std::string> original {"for (size_t i = 0; i < items.size(); i += 1) {", "unchanged"};
+    std::vector<std::string> updated {"unchanged", "return std::string(buffer, length);"};
+
+    HeckelDiff::Algorithm<std::string> h;
+
+    EXPECT_TRUE(HeckelDiff::NearMatcher().match(h.changes(original, updated)).empty());
+}
+
+TEST(NearMatch, PairsEachDeletedItemOnce) {
+
+    std::vector<std::string> original {"timeout_ms: 3000"};
+    std::vector<std::string> updated {"timeout_ms: 3001", "timeout_ms: 3002"};
+
+    HeckelDiff::NearMatchOptions options;
+    options.threshold = 0.5;
+
+    HeckelDiff::Algorithm<std::string> h;
+    const auto pairs = HeckelDiff::NearMatcher(options).match(h.changes(original, updated));
+
+    ASSERT_EQ(1u, pairs.size());
+    EXPECT_EQ(0u, pairs[0].old_index);
+}
+
+TEST(NearMatch, FingerprintsAreStable) {
+
+    const auto print = HeckelDiff::NearMatcher::fingerprint("    host = example.org", 3);
+
+    EXPECT_EQ(print, HeckelDiff::NearMatcher::fingerprint("    host = example.org", 3));
+    EXPECT_DOUBLE_EQ(1.0, HeckelDiff::NearMatcher::similarity(print, print));
+    EXPECT_DOUBLE_EQ(0.0, HeckelDiff::NearMatcher::similarity(print, ~print));
+}
+
+TEST(NearMatch, RejectsInvalidOptions) {
+
+    HeckelDiff::NearMatchOptions options;
+
+    options.sampled_bits = 65;
+    EXPECT_THROW(HeckelDiff::NearMatcher matcher(options), std::invalid_argument);
+
+    options = HeckelDiff::NearMatchOptions();
+    options.threshold = 1.5;
+    EXPECT_THROW(HeckelDiff::NearMatcher matcher(options), std::invalid_argument);
+
+    options = HeckelDiff::NearMatchOptions();
+    options.shingle_size = 0;
+    EXPECT_THROW(HeckelDiff::NearMatcher matcher(options), std::invalid_argument);
+}
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include "gtest/gtest.h"
+#include "heckel_diff.hpp"
+#include "helpers.hpp"
+
+static std::string baseline_path(const std::string &name) {
+    return ::testing::TempDir() + name;
+}
+
+TEST(PreparedBaseline, MatchesUnpreparedDiff) {
+
+    auto original = HeckelDiffHelpers::components_seperated_by_delimiter(
+            "much writing is like snow , a mass of long words and phrases falls upon the relevant facts covering up "
+            "the details .", ' ');
+    auto updated = HeckelDiffHelpers::components_seperated_by_delimiter(
+            "a mass of latin words falls upon the relevant facts like soft snow , covering up the details .", ' ');
+
+    HeckelDiff::Algorithm<std::string> h;
+
+    auto expected = h.diff(original, updated);
+
+    auto baseline = HeckelDiff::PreparedBaseline<std::string>::prepare(original);
+    auto actual = h.diff(baseline, updated);
+
+    EXPECT_EQ(expected, actual);
+
+    // the baseline is left untouched by a diff, so it can be reused
+    EXPECT_EQ(expected, h.diff(baseline, updated));
+}
+
+TEST(PreparedBaseline, IndexesSymbolsOnce) {
+
+    std::vector<size_t> original {7, 3, 7, 9, 7};
+
+    auto baseline = HeckelDiff::PreparedBaseline<size_t>::prepare(original);
+
+    EXPECT_EQ(5u, baseline.size());
+    EXPECT_EQ(3u, baseline.symbol_count());
+    EXPECT_EQ(HeckelDiff::PreparedBaseline<size_t>::NoSymbol, baseline.find(8));
+
+    const auto symbol = baseline.find(7);
+    const auto old_indexes = baseline.old_indexes(symbol);
+
+    ASSERT_EQ(3u, baseline.occurrences(symbol));
+    EXPECT_EQ(0u, old_indexes[0]);
+    EXPECT_EQ(2u, old_indexes[1]);
+    EXPECT_EQ(4u, old_indexes[2]);
+}
+
+TEST(PreparedBaseline, RecycledMatchesFresh) {
+
+    std::vector<std::vector<std::string>> originals {
+            {"A", "X", "C", "Y", "D", "W", "E", "A", "E"},
+            {"B", "B"},
+            {"much", "writing", "is", "like", "snow", ",", "a", "mass", "of", "long", "words", "is", "snow"}
+    };
+
+    auto recycled = HeckelDiff::PreparedBaseline<std::string>::prepare({"Z"});
+
+    for (const auto &original : originals) {
+
+        recycled = HeckelDiff::PreparedBaseline<std::string>::prepare(original, std::move(recycled));
+
+        const auto fresh = HeckelDiff::PreparedBaseline<std::string>::prepare(original);
+
+        ASSERT_EQ(fresh.size(), recycled.size());
+        ASSERT_EQ(fresh.symbol_count(), recycled.symbol_count());
+
+        for (size_t i = 0; i < original.size(); i += 1) {
+
+            const auto symbol = recycled.find(original[i]);
+
+            EXPECT_EQ(fresh.symbol_at(i), symbol);
+            EXPECT_EQ(fresh.occurrences(symbol), recycled.occurrences(symbol));
+            EXPECT_EQ(fresh.old_indexes(symbol)[0], recycled.old_indexes(symbol)[0]);
+            EXPECT_EQ(original[i], recycled.value(i));
+        }
+
+        EXPECT_EQ(HeckelDiff::PreparedBaseline<std::string>::NoSymbol, recycled.find("Z"));
+    }
+}
+
+TEST(PreparedBaseline, RoundTripsThroughMappedFile) {
+
+    std::vector<std::string> original {"A", "X", "C", "Y", "D", "W", "E", "A", "E"};
+    std::vector<std::string> updated {"A", "B", "C", "D", "E", "A", "Y", "Y"};
+
+    const auto path = baseline_path("heckel_diff_round_trip.baseline");
+
+    HeckelDiff::PreparedBaseline<std::string>::prepare(original).write(path);
+
+    auto mapped = HeckelDiff::PreparedBaseline<std::string>::map(path);
+
+    HeckelDiff::Algorithm<std::string> h;
+
+    EXPECT_EQ(original.size(), mapped.size());
+    EXPECT_EQ("W", mapped.value(5));
+    EXPECT_EQ(h.diff(original, updated), h.diff(mapped, updated));
+
+    std::remove(path.c_str());
+}
+
+TEST(PreparedBaseline, RejectsMismatchedFiles) {
+
+    const auto path = baseline_path("heckel_diff_mismatch.baseline");
+
+    HeckelDiff::PreparedBaseline<size_t>::prepare({1, 2, 3}).write(path);
+
+    EXPECT_THROW(HeckelDiff::PreparedBaseline<std::string>::map(path), std::runtime_error);
+    EXPECT_THROW(HeckelDiff::PreparedBaseline<uint32_t>::map(path), std::runtime_error);
+    EXPECT_THROW(HeckelDiff::PreparedBaseline<size_t>::map(path + ".missing"), std::runtime_error);
+
+    std::remove(path.c_str());
+}
+
+static std::vector<uint64_t> read_words(const std::string &path) {
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<uint64_t> words(bytes.size() / sizeof(uint64_t));
+    std::memcpy(words.data(), bytes.data(), bytes.size());
+
+    return words;
+}
+
+static void write_words(const std::string &path, const std::vector<uint64_t> &words) {
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+            .write(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(uint64_t));
+}
+
+// Where each section of a baseline file starts, following the layout in prepared_baseline.hpp.
+struct Layout {
+
+    size_t items;
+    size_t symbols;
+    size_t slots_at;
+    size_t old_indexes_at;
+    size_t positions_at;
+    size_t values_at;
+
+    explicit Layout(const std::vector<uint64_t> &words)
+            : items(words[4]), symbols(words[5]), slots_at(10 + 3 * symbols), old_indexes_at(slots_at + words[6]),
+              positions_at(old_indexes_at + items), values_at(positions_at + items) {}
+};
+
+TEST(PreparedBaseline, VerifyRejectsCorruptBodies) {
+
+    const auto path = baseline_path("heckel_diff_corrupt.baseline");
+
+    HeckelDiff::PreparedBaseline<std::string>::prepare({"A", "X", "C", "A", "E"}).write(path);
+
+    const auto words = read_words(path);
+    const Layout layout(words);
+
+    auto expect_rejected = [&](const size_t word, const uint64_t value) {
+
+        auto corrupt = words;
+        corrupt[word] = value;
+
+        write_words(path, corrupt);
+
+        // sections that still fit the file are trusted unless verified
+        EXPECT_NO_THROW(HeckelDiff::PreparedBaseline<std::string>::map(path));
+        EXPECT_THROW(HeckelDiff::PreparedBaseline<std::string>::map(path, true), std::runtime_error) << word;
+    };
+
+    expect_rejected(10 + 2, layout.items);  // first old index of symbol 0
+    expect_rejected(layout.slots_at, layout.symbols + 1);
+    expect_rejected(layout.old_indexes_at, layout.items);
+    expect_rejected(layout.positions_at + 1, layout.symbols);
+    expect_rejected(layout.values_at + 1, 1000);  // blob offset
+    expect_rejected(layout.values_at + layout.symbols, 1);
+
+    // the header and section sizes are always checked
+    auto truncated = words;
+    truncated[6] *= 2;
+
+    write_words(path, truncated);
+
+    EXPECT_THROW(HeckelDiff::PreparedBaseline<std::string>::map(path), std::runtime_error);
+
+    write_words(path, words);
+
+    EXPECT_NO_THROW(HeckelDiff::PreparedBaseline<std::string>::map(path, true));
+
+    std::remove(path.c_str());
+}
+
+template<typename T>
+static void expect_verified_corruption_is_safe(const std::vector<T> &original, const std::vector<T> &updated,
+                                               const std::string &path) {
+
+    HeckelDiff::PreparedBaseline<T>::prepare(original).write(path);
+
+    const auto words = read_words(path);
+
+    HeckelDiff::Algorithm<T> h;
+    size_t rejected = 0;
+
+    // any one word changed is either rejected or still safe to diff against
+    for (size_t i = 0; i < words.size(); i += 1) {
+
+        for (const uint64_t value : {words[i] + 1, words[i] - 1, uint64_t(0), std::numeric_limits<uint64_t>::max()}) {
+
+            auto corrupt = words;
+            corrupt[i] = value;
+
+            write_words(path, corrupt);
+
+            try {
+                h.diff(HeckelDiff::PreparedBaseline<T>::map(path, true), updated);
+            } catch (const std::runtime_error &) {
+                rejected += 1;
+            }
+        }
+    }
+
+    EXPECT_GT(rejected, words.size());
+
+    std::remove(path.c_str());
+}
+
+TEST(PreparedBaseline, VerifiedFilesAreSafeToDiffAgainst) {
+
+    expect_verified_corruption_is_safe<std::string>({"A", "X", "C", "Y", "D", "W", "E", "A", "E"},
+                                                    {"A", "B", "C", "D", "E", "A", "Y", "Y"},
+                                                    baseline_path("heckel_diff_corrupt_strings.baseline"));
+
+    expect_verified_corruption_is_safe<size_t>({7, 3, 7, 9, 7, 1, 3}, {3, 7, 7, 4, 9},
+                                               baseline_path("heckel_diff_corrupt_dense.baseline"));
+
+    expect_verified_corruption_is_safe<size_t>({7ull << 40, 3ull << 40, 7ull << 40, 9}, {9, 7ull << 40, 4},
+                                               baseline_path("heckel_diff_corrupt_sparse.baseline"));
+}
+
+TEST(PreparedBaseline, IndexesDenseAndSparseIntegersAlike) {
+
+    // ids close together are indexed by value, ids far apart are hashed
+    std::vector<size_t> dense {1007, 1003, 1007, 1009, 1001};
+    std::vector<size_t> sparse {7ull << 40, 3ull << 40, 7ull << 40, 9ull << 40, 1ull << 40};
+
+    const auto path = baseline_path("heckel_diff_dense.baseline");
+
+    HeckelDiff::PreparedBaseline<size_t>::prepare(dense).write(path);
+
+    const auto mapped = HeckelDiff::PreparedBaseline<size_t>::map(path);
+    const auto hashed = HeckelDiff::PreparedBaseline<size_t>::prepare(sparse);
+
+    for (size_t i = 0; i < dense.size(); i += 1) {
+
+        EXPECT_EQ(hashed.symbol_at(i), mapped.symbol_at(i));
+        EXPECT_EQ(mapped.symbol_at(i), mapped.find(dense[i]));
+        EXPECT_EQ(dense[i], mapped.value(i));
+    }
+
+    for (const size_t absent : {0, 1000, 1002, 1010, 5000}) {
+        EXPECT_EQ(HeckelDiff::PreparedBaseline<size_t>::NoSymbol, mapped.find(absent));
+    }
+
+    HeckelDiff::Algorithm<size_t> h;
+
+    std::vector<size_t> updated {1003, 1001, 1007, 1004, 1007, 2000};
+
+    EXPECT_EQ(h.diff(dense, updated), h.diff(mapped, updated));
+    EXPECT_EQ(std::vector<size_t>({1004, 2000}), h.diff(mapped, updated)[HeckelDiff::INSERTED]);
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include "gtest/gtest.h"
+#include "heckel_diff.hpp"
+
+static std::vector<size_t> range_of(const size_t first, const size_t last) {
+
+    std::vector<size_t> items;
+
+    for (auto i = first; i < last; i += 1) {
+        items.push_back(i);
+    }
+
+    return items;
+}
+
+TEST(Sketch, EstimatesJaccardSimilarity) {
+
+    // {0..999} and {500..1499} share a third of their union
+    const auto a = HeckelDiff::Sketch<size_t>::of(range_of(0, 1000), 256);
+    const auto b = HeckelDiff::Sketch<size_t>::of(range_of(500, 1500), 256);
+
+    EXPECT_NEAR(1.0 / 3.0, a.similarity(b), 0.1);
+    EXPECT_DOUBLE_EQ(1.0, a.similarity(a));
+    EXPECT_DOUBLE_EQ(0.0, a.similarity(HeckelDiff::Sketch<size_t>::of(range_of(5000, 6000), 256)));
+}
+
+TEST(Sketch, IsExactForSmallSets) {
+
+    std::vector<std::string> original {"A", "X", "C", "Y", "A"};
+    std::vector<std::string> updated {"A", "B", "C", "D"};
+
+    const auto baseline = HeckelDiff::PreparedBaseline<std::string>::prepare(original);
+
+    // {A, C} of {A, X, C, Y, B, D}
+    EXPECT_DOUBLE_EQ(2.0 / 6.0, HeckelDiff::Sketch<std::string>::of(baseline).similarity(
+            HeckelDiff::Sketch<std::string>::of(updated)));
+    EXPECT_DOUBLE_EQ(1.0, HeckelDiff::Sketch<std::string>::of(baseline).similarity(
+            HeckelDiff::Sketch<std::string>::of(original)));
+}
+
+TEST(Sketch, DissimilarInputsAreReplaced) {
+
+    std::vector<std::string> original {"A", "X", "C", "Y", "D", "W", "E", "A", "E"};
+    std::vector<std::string> updated {"A", "B", "F", "G", "H"};
+
+    HeckelDiff::Algorithm<std::string> h;
+
+    auto actual = h.diff(original, updated, 0.5);
+
+    EXPECT_EQ(updated, actual[HeckelDiff::INSERTED]);
+    EXPECT_EQ(original, actual[HeckelDiff::DELETED]);
+    EXPECT_TRUE(actual[HeckelDiff::MOVED].empty());
+    EXPECT_TRUE(actual[HeckelDiff::UNCHANGED].empty());
+}
+
+TEST(Sketch, SimilarInputsRunEveryPass) {
+
+    std::vector<std::string> original {"A", "X", "C", "Y", "D", "W", "E", "A", "E"};
+    std::vector<std::string> updated {"A", "B", "C", "D", "E", "A", "Y", "Y"};
+
+    HeckelDiff::Algorithm<std::string> h;
+
+    const auto baseline = HeckelDiff::PreparedBaseline<std::string>::prepare(original);
+    const auto baseline_sketch = HeckelDiff::Sketch<std::string>::of(baseline);
+
+    // the baseline's sketch is reused for every update diffed against it
+    for (size_t i = 0; i < 2; i += 1) {
+
+        EXPECT_EQ(h.diff(original, updated),
+                  h.diff(baseline, updated, baseline_sketch, HeckelDiff::Sketch<std::string>::of(updated), 0.5));
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include "gtest/gtest.h"
+#include "sorted_diff.hpp"
+
+TEST(SortedDiff, MatchesSetDifferences) {
+
+    std::mt19937 generator(7);
+
+    for (size_t round = 0; round < 200; round += 1) {
+
+        std::vector<size_t> original, updated;
+
+        for (size_t value = 0; value < 60; value += 1) {
+
+            if (generator() % 3 != 0) {
+                original.push_back(value);
+            }
+
+            if (generator() % 3 != 0) {
+                updated.push_back(value);
+            }
+        }
+
+        std::vector<size_t> expected_inserted, expected_deleted, expected_matched;
+
+        std::set_difference(updated.begin(), updated.end(), original.begin(), original.end(),
+                            std::back_inserter(expected_inserted));
+        std::set_difference(original.begin(), original.end(), updated.begin(), updated.end(),
+                            std::back_inserter(expected_deleted));
+        std::set_intersection(updated.begin(), updated.end(), original.begin(), original.end(),
+                              std::back_inserter(expected_matched));
+
+        HeckelDiff::SortedAlgorithm<size_t> h;
+
+        auto actual = h.diff(original, updated);
+
+        auto actual_matched = actual[HeckelDiff::MOVED];
+        actual_matched.insert(actual_matched.end(), actual[HeckelDiff::UNCHANGED].begin(),
+                              actual[HeckelDiff::UNCHANGED].end());
+        std::sort(actual_matched.begin(), actual_matched.end());
+
+        EXPECT_EQ(expected_inserted, actual[HeckelDiff::INSERTED]);
+        EXPECT_EQ(expected_deleted, actual[HeckelDiff::DELETED]);
+        EXPECT_EQ(expected_matched, actual_matched);
+    }
+}
+
+TEST(SortedDiff, UnchangedOnlyWherePositionsAgree) {
+
+    std::vector<size_t> original {1, 2, 3, 4, 5};
+    std::vector<size_t> updated {1, 3, 4, 5, 6};
+
+    HeckelDiff::Algorithm<size_t> heckel;
+    HeckelDiff::SortedAlgorithm<size_t> sorted;
+
+    EXPECT_EQ(heckel.diff(original, updated), sorted.diff(original, updated));
+}
+
+TEST(SortedDiff, MatchesDuplicatesOneToOne) {
+
+    std::vector<std::string> original {"a", "b", "b", "c"};
+    std::vector<std::string> updated {"b", "b", "b", "c", "d"};
+
+    HeckelDiff::SortedAlgorithm<std::string> h;
+
+    auto actual = h.diff(original, updated);
+
+    EXPECT_EQ(std::vector<std::string>({"a"}), actual[HeckelDiff::DELETED]);
+    EXPECT_EQ(std::vector<std::string>({"b", "d"}), actual[HeckelDiff::INSERTED]);
+    EXPECT_EQ(std::vector<std::string>({"b", "b"}), actual[HeckelDiff::MOVED]);
+    EXPECT_EQ(std::vector<std::string>({"c"}), actual[HeckelDiff::UNCHANGED]);
+}
+
+TEST(SortedDiff, StreamsInputIteratorsWithCustomComparator) {
+
+    struct Row {
+        uint32_t id;
+        std::string name;
+    };
+
+    const auto by_id = [](const Row &lhs, const Row &rhs) { return lhs.id < rhs.id; };
+
+    std::vector<Row> original {{1, "one"}, {3, "three"}, {5, "five"}};
+
+    // descending ids arrive from a stream, read once
+    std::istringstream cursor("5 4 1");
+    std::vector<uint32_t> ids;
+    std::vector<std::string> categories;
+
+    HeckelDiff::SortedAlgorithm<uint32_t, std::greater<uint32_t>> descending;
+    std::vector<uint32_t> original_ids;
+
+    std::transform(original.rbegin(), original.rend(), std::back_inserter(original_ids),
+                   [](const Row &row) { return row.id; });
+
+    descending.diff(original_ids.begin(), original_ids.end(),
+                    std::istream_iterator<uint32_t>(cursor), std::istream_iterator<uint32_t>(),
+                    [&](HeckelDiff::SortedAlgorithm<uint32_t>::Category category, const uint32_t &id,
+                        const size_t old_index, const size_t new_index) {
+
+                        ids.push_back(id);
+                        categories.push_back(category == HeckelDiff::Changes<uint32_t>::Inserted ? "i"
+                                             : category == HeckelDiff::Changes<uint32_t>::Deleted ? "d"
+                                             : category == HeckelDiff::Changes<uint32_t>::Moved ? "m" : "u");
+
+                        EXPECT_TRUE(old_index != HeckelDiff::NotFound || new_index != HeckelDiff::NotFound);
+                    });
+
+    EXPECT_EQ(std::vector<uint32_t>({5, 4, 3, 1}), ids);
+    EXPECT_EQ(std::vector<std::string>({"u", "i", "d", "u"}), categories);
+
+    // a key comparator matches rows whose other fields differ
+    std::vector<Row> updated {{1, "uno"}, {5, "cinco"}};
+    size_t matched = 0;
+
+    HeckelDiff::SortedAlgorithm<Row, decltype(by_id)> rows(by_id);
+
+    rows.diff(original.begin(), original.end(), updated.begin(), updated.end(),
+              [&](HeckelDiff::Changes<Row>::Category category, const Row &, const size_t, const size_t) {
+                  matched += category == HeckelDiff::Changes<Row>::Moved
+                             || category == HeckelDiff::Changes<Row>::Unchanged;
+              });
+
+    EXPECT_EQ(2u, matched);
+}
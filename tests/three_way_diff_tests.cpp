@@ -0,0 +1,90 @@
+/*
+ * Copyright 2017 Rowun Giles - http://github.com/rowungiles
+ */
+
+#include "gtest/gtest.h"
+#include "three_way_diff.hpp"
+#include "helpers.hpp"
+
+using Merge = HeckelDiff::ThreeWayAlgorithm<std::string>;
+
+static std::vector<std::string> words(const std::string &text) {
+    return HeckelDiffHelpers::components_seperated_by_delimiter(text, ' ');
+}
+
+TEST(ThreeWayDiff, MergesIndependentChanges) {
+
+    const auto base = words("a b c d e f g");
+    const auto ours = words("a B c d e f g");
+    const auto theirs = words("a b c d e f g h");
+
+    Merge h;
+
+    const auto regions = h.merge(base, ours, theirs);
+
+    std::vector<std::string> merged;
+
+    ASSERT_TRUE(Merge::resolve(regions, ours, theirs, merged));
+    EXPECT_EQ(words("a B c d e f g h"), merged);
+}
+
+TEST(ThreeWayDiff, MarksConflicts) {
+
+    const auto base = words("a b c d e");
+    const auto ours = words("a x c d e");
+    const auto theirs = words("a y c d e");
+
+    Merge h(false);
+
+    const auto regions = h.merge(base, ours, theirs);
+
+    ASSERT_EQ(3u, regions.size());
+    EXPECT_EQ(Merge::Region::Unchanged, regions[0].kind);
+    EXPECT_EQ(Merge::Region::Conflict, regions[1].kind);
+    EXPECT_EQ(Merge::Region::Unchanged, regions[2].kind);
+
+    EXPECT_EQ(1u, regions[1].base_begin);
+    EXPECT_EQ(2u, regions[1].base_end);
+    EXPECT_EQ(1u, regions[1].ours_begin);
+    EXPECT_EQ(1u, regions[1].theirs_begin);
+
+    std::vector<std::string> merged;
+
+    EXPECT_FALSE(Merge::resolve(regions, ours, theirs, merged));
+}
+
+TEST(ThreeWayDiff, IdenticalChangesDoNotConflict) {
+
+    const auto base = words("a b c d");
+    const auto ours = words("a z c d");
+    const auto theirs = words("a z c d");
+
+    Merge h;
+
+    const auto regions = h.merge(base, ours, theirs);
+
+    ASSERT_EQ(3u, regions.size());
+    EXPECT_EQ(Merge::Region::Both, regions[1].kind);
+}
+
+TEST(ThreeWayDiff, SharesOnePreparedBase) {
+
+    const auto base = words("one two three four five six");
+    const auto prepared = HeckelDiff::PreparedBaseline<std::string>::prepare(base);
+
+    const auto ours = words("zero one two three four five six");
+    const auto theirs = words("one two three four six");
+
+    Merge h;
+
+    std::vector<std::string> merged;
+
+    ASSERT_TRUE(Merge::resolve(h.merge(prepared, ours, theirs), ours, theirs, merged));
+    EXPECT_EQ(words("zero one two three four six"), merged);
+
+    // moving a word is a deletion and an insertion, which conflicts with an edit beside it
+    const auto moved = words("two three four five six one");
+    const auto edited = words("uno two three four five six");
+
+    EXPECT_FALSE(Merge::resolve(h.merge(prepared, moved, edited), moved, edited, merged));
+}